@@ -0,0 +1,90 @@
+#include "allocators.h"
+
+#include <cstdint>
+
+MonotonicArena::MonotonicArena(std::size_t block_size)
+    : blocks_(), block_size_(block_size), current_(nullptr), left_(0),
+      bytes_used_(0), bytes_reserved_(0) {}
+
+void *MonotonicArena::Allocate(std::size_t bytes, std::size_t alignment) {
+  if (bytes == 0)
+    bytes = 1;
+  std::size_t padding =
+      (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) %
+      alignment;
+  if (current_ == nullptr || padding + bytes > left_) {
+    // Блоки выделяются new char[] и выровнены не хуже max_align_t; для
+    // большего выравнивания запрашивается запас.
+    std::size_t extra =
+        alignment > alignof(std::max_align_t) ? alignment - 1 : 0;
+    if (bytes + extra > block_size_ / 4) {
+      // Крупный запрос: отдельный блок, текущий остается в работе.
+      blocks_.emplace_back(new char[bytes + extra]);
+      bytes_reserved_ += bytes + extra;
+      bytes_used_ += bytes;
+      char *block = blocks_.back().get();
+      return block + (alignment - reinterpret_cast<std::uintptr_t>(block) %
+                                      alignment) %
+                         alignment;
+    }
+    blocks_.emplace_back(new char[block_size_]);
+    bytes_reserved_ += block_size_;
+    current_ = blocks_.back().get();
+    left_ = block_size_;
+    padding =
+        (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) %
+        alignment;
+  }
+  char *result = current_ + padding;
+  current_ = result + bytes;
+  left_ -= padding + bytes;
+  bytes_used_ += bytes;
+  return result;
+}
+
+void MonotonicArena::Release() {
+  blocks_.clear();
+  current_ = nullptr;
+  left_ = 0;
+  bytes_used_ = 0;
+  bytes_reserved_ = 0;
+}
+
+std::size_t MonotonicArena::BytesUsed() const { return bytes_used_; }
+
+std::size_t MonotonicArena::BytesReserved() const { return bytes_reserved_; }
+
+SizeClassPool::SizeClassPool() : free_(), chunks_() {}
+
+void *SizeClassPool::Allocate(std::size_t bytes, std::size_t alignment) {
+  if (bytes > kMaxClassSize || alignment > kMinClassSize)
+    return ::operator new(bytes);
+  std::size_t size_class = ClassOf(bytes);
+  FreeNode *node = free_[size_class];
+  if (node != nullptr) {
+    free_[size_class] = node->next;
+    return node;
+  }
+  return chunks_.Allocate(kMinClassSize << size_class, kMinClassSize);
+}
+
+void SizeClassPool::Deallocate(void *pointer, std::size_t bytes,
+                               std::size_t alignment) noexcept {
+  if (pointer == nullptr)
+    return;
+  if (bytes > kMaxClassSize || alignment > kMinClassSize) {
+    ::operator delete(pointer);
+    return;
+  }
+  std::size_t size_class = ClassOf(bytes);
+  FreeNode *node = static_cast<FreeNode *>(pointer);
+  node->next = free_[size_class];
+  free_[size_class] = node;
+}
+
+std::size_t SizeClassPool::ClassOf(std::size_t bytes) {
+  std::size_t size_class = 0;
+  while ((kMinClassSize << size_class) < bytes)
+    ++size_class;
+  return size_class;
+}
@@ -0,0 +1,201 @@
+#ifndef ALLOCATORS_H_
+#define ALLOCATORS_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+/// <summary>Монотонная арена: память выдается подряд из крупных блоков и
+/// освобождается только вся сразу.</summary>
+/// <remarks>Выделение — сдвиг указателя внутри текущего блока, освобождение
+/// отдельного участка ничего не делает. Подходит для множества
+/// короткоживущих объектов с общим временем жизни (например, множеств книг
+/// всех читателей). Не потокобезопасна.</remarks>
+class MonotonicArena {
+public:
+  /// <summary>Размер блока по умолчанию.</summary>
+  static constexpr std::size_t kDefaultBlockSize = 256 * 1024;
+
+  /// <summary>Создает пустую арену; блоки выделяются при первом
+  /// запросе.</summary>
+  /// <param name="block_size">Размер блока. Запросы больше четверти блока
+  /// получают отдельный блок точного размера.</param>
+  explicit MonotonicArena(std::size_t block_size = kDefaultBlockSize);
+
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+  /// <summary>Выделяет участок памяти.</summary>
+  /// <param name="bytes">Размер участка.</param>
+  /// <param name="alignment">Выравнивание (степень двойки).</param>
+  /// <returns>Указатель на участок; действителен до Release или уничтожения
+  /// арены.</returns>
+  void *Allocate(std::size_t bytes, std::size_t alignment);
+
+  /// <summary>Освобождает все блоки за один шаг.</summary>
+  /// <remarks>Все выданные участки становятся недействительными; объекты в
+  /// них должны быть уже разрушены или не требовать разрушения.</remarks>
+  void Release();
+
+  /// <summary>Возвращает суммарный размер выданных участков.</summary>
+  std::size_t BytesUsed() const;
+
+  /// <summary>Возвращает суммарный размер блоков.</summary>
+  std::size_t BytesReserved() const;
+
+private:
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::size_t block_size_;
+  /// <summary>Свободная часть текущего блока.</summary>
+  char *current_;
+  std::size_t left_;
+  std::size_t bytes_used_;
+  std::size_t bytes_reserved_;
+};
+
+/// <summary>Пул участков по классам размеров (степени двойки от 16 байт до
+/// 4 КБ) со списками свободных участков.</summary>
+/// <remarks>Освобожденный участок возвращается в список своего класса и
+/// переиспользуется следующим запросом того же класса без обращения к
+/// malloc; новые участки нарезаются из MonotonicArena. Более крупные или
+/// сильнее выровненные запросы передаются operator new. Память возвращается
+/// системе при уничтожении пула. Не потокобезопасен.</remarks>
+class SizeClassPool {
+public:
+  SizeClassPool();
+
+  SizeClassPool(const SizeClassPool &) = delete;
+  SizeClassPool &operator=(const SizeClassPool &) = delete;
+
+  /// <summary>Выделяет участок памяти.</summary>
+  /// <param name="bytes">Размер участка.</param>
+  /// <param name="alignment">Выравнивание (степень двойки).</param>
+  void *Allocate(std::size_t bytes, std::size_t alignment);
+
+  /// <summary>Возвращает участок в пул.</summary>
+  /// <param name="pointer">Участок, выданный Allocate.</param>
+  /// <param name="bytes">Размер, переданный Allocate.</param>
+  /// <param name="alignment">Выравнивание, переданное Allocate.</param>
+  void Deallocate(void *pointer, std::size_t bytes,
+                  std::size_t alignment) noexcept;
+
+private:
+  static constexpr std::size_t kMinClassSize = 16;
+  static constexpr std::size_t kClassCount = 9;
+  static constexpr std::size_t kMaxClassSize = kMinClassSize
+                                               << (kClassCount - 1);
+
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  FreeNode *free_[kClassCount];
+  MonotonicArena chunks_;
+
+  /// <summary>Номер класса для участка размера bytes.</summary>
+  static std::size_t ClassOf(std::size_t bytes);
+};
+
+/// <summary>Аллокатор, выделяющий память из MonotonicArena.</summary>
+/// <typeparam name="T">Тип элементов.</typeparam>
+/// <remarks>deallocate ничего не делает: память возвращается вместе со всей
+/// ареной. Аллокатор без арены (по умолчанию) работает через operator new,
+/// поэтому копии контейнеров (select_on_container_copy_construction)
+/// живут в обычной куче и не привязаны ко времени жизни арены.</remarks>
+template <typename T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  ArenaAllocator() noexcept : arena_(nullptr) {}
+
+  /// <summary>Создает аллокатор над ареной.</summary>
+  /// <param name="arena">Арена; должна пережить все выделенное.</param>
+  explicit ArenaAllocator(MonotonicArena *arena) noexcept : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+      : arena_(other.Arena()) {}
+
+  T *allocate(std::size_t count) {
+    if (arena_ != nullptr)
+      return static_cast<T *>(arena_->Allocate(count * sizeof(T), alignof(T)));
+    return static_cast<T *>(::operator new(count * sizeof(T)));
+  }
+
+  void deallocate(T *pointer, std::size_t) noexcept {
+    if (arena_ == nullptr)
+      ::operator delete(pointer);
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const {
+    return ArenaAllocator();
+  }
+
+  /// <summary>Возвращает арену или nullptr.</summary>
+  MonotonicArena *Arena() const noexcept { return arena_; }
+
+private:
+  MonotonicArena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.Arena() == b.Arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.Arena() != b.Arena();
+}
+
+/// <summary>Аллокатор, выделяющий память из SizeClassPool.</summary>
+/// <typeparam name="T">Тип элементов.</typeparam>
+/// <remarks>Для контейнеров, которые часто создаются и уничтожаются или
+/// растут и сжимаются: освобожденные массивы переиспользуются. Копии
+/// аллокатора разделяют пул; пул должен пережить все выделенное. Аллокатор
+/// без пула (по умолчанию) работает через operator new.</remarks>
+template <typename T> class PoolAllocator {
+public:
+  using value_type = T;
+
+  PoolAllocator() noexcept : pool_(nullptr) {}
+
+  /// <summary>Создает аллокатор над пулом.</summary>
+  /// <param name="pool">Пул.</param>
+  explicit PoolAllocator(SizeClassPool *pool) noexcept : pool_(pool) {}
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U> &other) noexcept : pool_(other.Pool()) {}
+
+  T *allocate(std::size_t count) {
+    if (pool_ != nullptr)
+      return static_cast<T *>(pool_->Allocate(count * sizeof(T), alignof(T)));
+    return static_cast<T *>(::operator new(count * sizeof(T)));
+  }
+
+  void deallocate(T *pointer, std::size_t count) noexcept {
+    if (pool_ != nullptr)
+      pool_->Deallocate(pointer, count * sizeof(T), alignof(T));
+    else
+      ::operator delete(pointer);
+  }
+
+  /// <summary>Возвращает пул.</summary>
+  SizeClassPool *Pool() const noexcept { return pool_; }
+
+private:
+  SizeClassPool *pool_;
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+  return a.Pool() == b.Pool();
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T> &a, const PoolAllocator<U> &b) {
+  return a.Pool() != b.Pool();
+}
+
+#endif // ALLOCATORS_H_
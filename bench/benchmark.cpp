@@ -0,0 +1,709 @@
+#include "allocators.h"
+#include "book_analyzer.h"
+#include "competition.h"
+#include "concurrent_dictionary.h"
+#include "concurrent_unordered_set.h"
+#include "dictionary.h"
+#include "metrics.h"
+#include "unordered_set.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// <summary>Параметры запуска (задаются аргументами командной
+/// строки).</summary>
+struct BenchConfig {
+  std::uint64_t seed = 42;
+  std::size_t set_ops = 1000000;
+  std::size_t titles = 20000;
+  std::size_t readers = 5000;
+  std::size_t books_per_reader = 50;
+  std::size_t athletes = 100000;
+  std::size_t events = 50;
+  std::size_t threads = 1;
+  std::string dir = ".";
+};
+
+/// <summary>Результат одного замера.</summary>
+struct BenchResult {
+  std::string name;
+  std::size_t ops;
+  double seconds;
+  long peak_rss_kb;
+};
+
+/// <summary>Пиковый размер резидентной памяти процесса, КБ.</summary>
+long PeakRssKb() {
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return -1;
+  return usage.ru_maxrss;
+}
+
+/// <summary>Засекает время выполнения body.</summary>
+template <typename Body> double Measure(Body body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+/// <summary>Не дает компилятору выбросить вычисление результата.</summary>
+volatile std::size_t g_sink = 0;
+
+/// <summary>Подавляет стандартный вывод на время жизни объекта.</summary>
+/// <remarks>Результаты пишутся через OutputSink прямо в дескриптор 1, поэтому
+/// он временно перенаправляется в /dev/null.</remarks>
+class QuietCout {
+public:
+  QuietCout() : saved_fd_(-1) {
+    std::cout.flush();
+    std::fflush(stdout);
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+      saved_fd_ = ::dup(1);
+      ::dup2(null_fd, 1);
+      ::close(null_fd);
+    }
+  }
+  ~QuietCout() {
+    std::cout.flush();
+    std::fflush(stdout);
+    if (saved_fd_ >= 0) {
+      ::dup2(saved_fd_, 1);
+      ::close(saved_fd_);
+    }
+  }
+
+private:
+  int saved_fd_;
+};
+
+std::vector<std::string> MakeKeys(std::mt19937_64 &rng, std::size_t count) {
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+    keys.push_back("key_" + std::to_string(rng()));
+  return keys;
+}
+
+/// <summary>Склеивает ключи в text и возвращает представления на них — как
+/// ключи, вырезанные из прочитанной строки.</summary>
+std::vector<std::string_view> MakeKeyViews(const std::vector<std::string> &keys,
+                                           std::string &text) {
+  text.clear();
+  for (const std::string &key : keys)
+    text += key;
+  std::vector<std::string_view> views;
+  views.reserve(keys.size());
+  std::size_t offset = 0;
+  for (const std::string &key : keys) {
+    views.emplace_back(text.data() + offset, key.size());
+    offset += key.size();
+  }
+  return views;
+}
+
+void BenchSetInt(const BenchConfig &config, std::vector<BenchResult> &results) {
+  std::mt19937_64 rng(config.seed);
+  std::vector<int> values(config.set_ops);
+  for (int &value : values)
+    value = static_cast<int>(rng());
+
+  UnorderedSet<int> set;
+  double t = Measure([&] {
+    for (int value : values)
+      set.Add(value);
+  });
+  results.push_back({"set_int_add", values.size(), t, PeakRssKb()});
+
+  std::size_t found = 0;
+  t = Measure([&] {
+    for (int value : values)
+      found += set.Contains(value);
+  });
+  g_sink = g_sink + found;
+  results.push_back({"set_int_contains", values.size(), t, PeakRssKb()});
+
+  t = Measure([&] {
+    for (int value : values)
+      set.Remove(value);
+  });
+  results.push_back({"set_int_remove", values.size(), t, PeakRssKb()});
+}
+
+/// <summary>Множество создается, заполняется и уничтожается
+/// config.readers раз.</summary>
+template <typename Set>
+double MeasureShortLivedSets(const BenchConfig &config,
+                             const std::vector<int> &values,
+                             const typename Set::allocator_type &allocator) {
+  return Measure([&] {
+    std::size_t total = 0;
+    for (std::size_t r = 0; r < config.readers; ++r) {
+      Set set(allocator);
+      for (std::size_t i = 0; i < config.books_per_reader; ++i)
+        set.Add(values[(r + i) % values.size()]);
+      total += set.Size();
+    }
+    g_sink = g_sink + total;
+  });
+}
+
+void BenchSetAllocators(const BenchConfig &config,
+                        std::vector<BenchResult> &results) {
+  // Без значений множествам нечего добавлять (и индекс по модулю размера
+  // не определен).
+  if (config.titles == 0)
+    return;
+  std::mt19937_64 rng(config.seed);
+  std::vector<int> values(config.titles);
+  for (int &value : values)
+    value = static_cast<int>(rng());
+  std::size_t ops = config.readers * config.books_per_reader;
+
+  using HeapSet = UnorderedSet<int>;
+  double t = MeasureShortLivedSets<HeapSet>(config, values,
+                                            HeapSet::allocator_type());
+  results.push_back({"set_small_heap", ops, t, PeakRssKb()});
+
+  using PoolSet = UnorderedSet<int, std::hash<int>, std::equal_to<int>,
+                               PoolAllocator<int>>;
+  SizeClassPool pool;
+  t = MeasureShortLivedSets<PoolSet>(config, values,
+                                     PoolAllocator<int>(&pool));
+  results.push_back({"set_small_pool", ops, t, PeakRssKb()});
+
+  using ArenaSet = UnorderedSet<int, std::hash<int>, std::equal_to<int>,
+                                ArenaAllocator<int>>;
+  MonotonicArena arena;
+  t = MeasureShortLivedSets<ArenaSet>(config, values,
+                                      ArenaAllocator<int>(&arena));
+  arena.Release();
+  results.push_back({"set_small_arena", ops, t, PeakRssKb()});
+
+  using InlineSet = UnorderedSet<int, std::hash<int>, std::equal_to<int>,
+                                 std::allocator<int>, 8>;
+  t = MeasureShortLivedSets<InlineSet>(config, values,
+                                       InlineSet::allocator_type());
+  results.push_back({"set_small_inline", ops, t, PeakRssKb()});
+}
+
+void BenchSetString(const BenchConfig &config,
+                    std::vector<BenchResult> &results) {
+  std::mt19937_64 rng(config.seed + 1);
+  std::vector<std::string> keys = MakeKeys(rng, config.set_ops);
+
+  UnorderedSet<std::string> set;
+  double t = Measure([&] {
+    for (const std::string &key : keys)
+      set.Add(key);
+  });
+  results.push_back({"set_string_add", keys.size(), t, PeakRssKb()});
+
+  std::size_t found = 0;
+  t = Measure([&] {
+    for (const std::string &key : keys)
+      found += set.Contains(key);
+  });
+  g_sink = g_sink + found;
+  results.push_back({"set_string_contains", keys.size(), t, PeakRssKb()});
+
+  // Поиск по string_view: без прозрачного хеша нужна временная строка,
+  // с StringHash/StringEqual — нет.
+  std::string text;
+  std::vector<std::string_view> views = MakeKeyViews(keys, text);
+  t = Measure([&] {
+    for (std::string_view view : views)
+      found += set.Contains(std::string(view));
+  });
+  results.push_back({"set_string_contains_view_copy", views.size(), t,
+                     PeakRssKb()});
+
+  UnorderedSet<std::string, StringHash, StringEqual> transparent;
+  for (const std::string &key : keys)
+    transparent.Add(key);
+  t = Measure([&] {
+    for (std::string_view view : views)
+      found += transparent.Contains(view);
+  });
+  g_sink = g_sink + found;
+  results.push_back({"set_string_contains_view", views.size(), t,
+                     PeakRssKb()});
+
+  t = Measure([&] {
+    for (const std::string &key : keys)
+      set.Remove(key);
+  });
+  results.push_back({"set_string_remove", keys.size(), t, PeakRssKb()});
+}
+
+void BenchDictionary(const BenchConfig &config,
+                     std::vector<BenchResult> &results) {
+  std::mt19937_64 rng(config.seed + 2);
+  std::vector<std::string> keys = MakeKeys(rng, config.set_ops);
+
+  Dictionary<std::string, long long> dict;
+  double t = Measure([&] {
+    long long i = 0;
+    for (const std::string &key : keys)
+      dict.Add(key, i++);
+  });
+  results.push_back({"dict_add", keys.size(), t, PeakRssKb()});
+
+  long long sum = 0;
+  t = Measure([&] {
+    for (const std::string &key : keys) {
+      const long long *value = dict.Get(key);
+      if (value != nullptr)
+        sum += *value;
+    }
+  });
+  g_sink = g_sink + static_cast<std::size_t>(sum);
+  results.push_back({"dict_get", keys.size(), t, PeakRssKb()});
+
+  std::string text;
+  std::vector<std::string_view> views = MakeKeyViews(keys, text);
+  Dictionary<std::string, long long, StringHash, StringEqual> transparent;
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    transparent.Add(keys[i], static_cast<long long>(i));
+  t = Measure([&] {
+    for (std::string_view view : views) {
+      const long long *value = transparent.Get(view);
+      if (value != nullptr)
+        sum += *value;
+    }
+  });
+  g_sink = g_sink + static_cast<std::size_t>(sum);
+  results.push_back({"dict_get_view", views.size(), t, PeakRssKb()});
+
+  t = Measure([&] {
+    for (const std::string &key : keys)
+      dict.Remove(key);
+  });
+  results.push_back({"dict_remove", keys.size(), t, PeakRssKb()});
+}
+
+/// <summary>Засекает время, за которое threads потоков выполняют
+/// body(begin, end) над равными частями [0, count).</summary>
+template <typename Body>
+double MeasureThreads(std::size_t threads, std::size_t count, Body body) {
+  return Measure([&] {
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+      workers.emplace_back(body, count * t / threads,
+                           count * (t + 1) / threads);
+    }
+    for (std::thread &worker : workers)
+      worker.join();
+  });
+}
+
+/// <summary>Одновременное добавление из config.threads потоков: общее
+/// множество и словарь-счетчик под одним мьютексом против сегментированных
+/// ConcurrentUnorderedSet/ConcurrentDictionary.</summary>
+void BenchConcurrent(const BenchConfig &config,
+                     std::vector<BenchResult> &results) {
+  std::size_t threads = config.threads;
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads == 0)
+    threads = 1;
+  // Ключи повторяются: примерно половина операций попадает в уже
+  // добавленные элементы, как названия книг у разных читателей.
+  std::mt19937_64 rng(config.seed + 5);
+  std::vector<int> values(config.set_ops);
+  for (int &value : values)
+    value = static_cast<int>(rng() % (config.set_ops / 2 + 1));
+  std::vector<std::string> base = MakeKeys(rng, config.set_ops / 8 + 1);
+  std::vector<std::string> keys(config.set_ops);
+  for (std::string &key : keys)
+    key = base[rng() % base.size()];
+
+  {
+    std::mutex mutex;
+    UnorderedSet<int> set;
+    double t = MeasureThreads(threads, values.size(),
+                              [&](std::size_t begin, std::size_t end) {
+                                for (std::size_t i = begin; i < end; ++i) {
+                                  std::lock_guard<std::mutex> lock(mutex);
+                                  set.Add(values[i]);
+                                }
+                              });
+    results.push_back({"concurrent_set_add_mutex", values.size(), t,
+                       PeakRssKb()});
+  }
+  {
+    ConcurrentUnorderedSet<int> set;
+    double t = MeasureThreads(threads, values.size(),
+                              [&](std::size_t begin, std::size_t end) {
+                                for (std::size_t i = begin; i < end; ++i)
+                                  set.Add(values[i]);
+                              });
+    results.push_back({"concurrent_set_add_sharded", values.size(), t,
+                       PeakRssKb()});
+    std::atomic<std::size_t> found{0};
+    t = MeasureThreads(threads, values.size(),
+                       [&](std::size_t begin, std::size_t end) {
+                         std::size_t local = 0;
+                         for (std::size_t i = begin; i < end; ++i)
+                           local += set.Contains(values[i]);
+                         found += local;
+                       });
+    g_sink = g_sink + found.load();
+    results.push_back({"concurrent_set_contains_sharded", values.size(), t,
+                       PeakRssKb()});
+  }
+  {
+    std::mutex mutex;
+    Dictionary<std::string, long long> counts;
+    double t = MeasureThreads(threads, keys.size(),
+                              [&](std::size_t begin, std::size_t end) {
+                                for (std::size_t i = begin; i < end; ++i) {
+                                  std::lock_guard<std::mutex> lock(mutex);
+                                  if (long long *count = counts.Get(keys[i]))
+                                    ++*count;
+                                  else
+                                    counts.Add(keys[i], 1);
+                                }
+                              });
+    results.push_back({"concurrent_dict_count_mutex", keys.size(), t,
+                       PeakRssKb()});
+  }
+  {
+    ConcurrentDictionary<std::string, long long> counts;
+    double t = MeasureThreads(
+        threads, keys.size(), [&](std::size_t begin, std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i)
+            counts.AddOrUpdate(keys[i], 1, [](long long &count) { ++count; });
+        });
+    results.push_back({"concurrent_dict_count_sharded", keys.size(), t,
+                       PeakRssKb()});
+  }
+}
+
+/// <summary>Пишет входной файл анализа книг: каталог и читателей со
+/// случайными наборами книг (часть названий вне каталога).</summary>
+void WriteBooksInput(const BenchConfig &config, const std::string &path) {
+  std::mt19937_64 rng(config.seed + 3);
+  std::ofstream out(path);
+  for (std::size_t i = 0; i < config.titles; ++i)
+    out << "Книга " << i << '\n';
+  out << '\n';
+  std::uniform_int_distribution<std::size_t> title(0, config.titles + 99);
+  std::uniform_int_distribution<std::size_t> count(1, config.books_per_reader);
+  for (std::size_t r = 0; r < config.readers; ++r) {
+    std::size_t k = count(rng);
+    for (std::size_t j = 0; j < k; ++j) {
+      if (j > 0)
+        out << " ; ";
+      std::size_t id = title(rng);
+      if (id < config.titles)
+        out << "Книга " << id;
+      else
+        out << "Новая книга " << id;
+    }
+    out << '\n';
+  }
+}
+
+/// <summary>Пишет входной файл многоборья: N спортсменов, M видов.</summary>
+void WriteCompetitionInput(const BenchConfig &config,
+                           const std::string &path) {
+  std::mt19937_64 rng(config.seed + 4);
+  std::uniform_int_distribution<int> score(0, 100);
+  std::ofstream out(path);
+  out << config.athletes << '\n' << config.events << '\n';
+  for (std::size_t i = 0; i < config.athletes; ++i) {
+    out << "Фамилия" << i << " Имя" << i;
+    for (std::size_t j = 0; j < config.events; ++j)
+      out << ' ' << score(rng);
+    out << '\n';
+  }
+}
+
+void BenchAnalyzer(const BenchConfig &config,
+                   std::vector<BenchResult> &results) {
+  std::string input = config.dir + "/bench_books.txt";
+  std::string output = config.dir + "/bench_books_out.txt";
+  WriteBooksInput(config, input);
+
+  QuietCout quiet;
+  for (AnalysisMode mode :
+       {AnalysisMode::kSets, AnalysisMode::kBitset, AnalysisMode::kIncremental,
+        AnalysisMode::kSorted}) {
+    const char *suffix = mode == AnalysisMode::kSets     ? "sets"
+                         : mode == AnalysisMode::kBitset ? "bitset"
+                         : mode == AnalysisMode::kSorted ? "sorted"
+                                                         : "incremental";
+    BookAnalyzer analyzer;
+    analyzer.SetMode(mode);
+    analyzer.SetThreadCount(config.threads);
+    bool ok = true;
+    double t = Measure([&] { ok = analyzer.ReadData(input); });
+    if (!ok) {
+      std::cerr << "benchmark: не удалось прочитать " << input << '\n';
+      break;
+    }
+    results.push_back({std::string("analyzer_read_") + suffix, config.readers,
+                       t, PeakRssKb()});
+    t = Measure([&] { analyzer.Analyze(); });
+    results.push_back({std::string("analyzer_analyze_") + suffix,
+                       config.readers, t, PeakRssKb()});
+    t = Measure([&] { analyzer.SaveResults(output); });
+    results.push_back({std::string("analyzer_save_") + suffix, config.titles,
+                       t, PeakRssKb()});
+
+    // Запросов столько же, сколько читателей, а названия выбираются по
+    // модулю config.titles: без книг пакет не составить.
+    if (mode == AnalysisMode::kSets && config.titles != 0) {
+      // Пакет вперемешку: читатели книги, общие книги пары читателей, книги
+      // с не меньше чем k читателями. Первый вызов строит индекс.
+      std::mt19937_64 rng(config.seed + 6);
+      // Порог выше среднего числа читателей книги: ответы — десятки книг.
+      std::size_t mean_readers =
+          config.readers * (config.books_per_reader + 1) / 2 /
+          (config.titles + 1);
+      std::vector<std::string> titles(config.readers);
+      std::vector<BookQuery> queries(config.readers);
+      for (std::size_t q = 0; q < queries.size(); ++q) {
+        BookQuery &query = queries[q];
+        if (q % 3 == 0) {
+          titles[q] = "Книга " + std::to_string(rng() % config.titles);
+          query.title = titles[q];
+        } else if (q % 3 == 1) {
+          query.kind = BookQuery::Kind::kReadByGroup;
+          query.readers = {rng() % config.readers, rng() % config.readers};
+        } else {
+          query.kind = BookQuery::Kind::kReadByAtLeast;
+          query.min_readers = 2 * mean_readers + 1 + rng() % 4;
+        }
+      }
+      std::size_t answers = 0;
+      t = Measure([&] { answers += analyzer.RunQueries(queries).size(); });
+      results.push_back(
+          {"analyzer_queries_build", queries.size(), t, PeakRssKb()});
+      t = Measure([&] { answers += analyzer.RunQueries(queries).size(); });
+      results.push_back({"analyzer_queries", queries.size(), t, PeakRssKb()});
+      g_sink = g_sink + answers;
+
+      std::string snapshot = config.dir + "/bench_books.snap";
+      t = Measure([&] { ok = analyzer.SaveSnapshot(snapshot); });
+      results.push_back(
+          {"analyzer_snapshot_save", config.readers, t, PeakRssKb()});
+      BookAnalyzer loaded;
+      t = Measure([&] {
+        ok = ok && loaded.LoadSnapshot(snapshot);
+        loaded.Analyze();
+      });
+      results.push_back(
+          {"analyzer_snapshot_load", config.readers, t, PeakRssKb()});
+      t = Measure([&] { loaded.SaveResults(output); });
+      results.push_back(
+          {"analyzer_snapshot_results", config.titles, t, PeakRssKb()});
+      std::remove(snapshot.c_str());
+      if (!ok) {
+        std::cerr << "benchmark: не удалось сохранить или загрузить снимок\n";
+        break;
+      }
+    }
+  }
+
+  {
+    BookAnalyzer analyzer;
+    analyzer.SetReaderStorage(ReaderStorage::kCompressed);
+    analyzer.SetThreadCount(config.threads);
+    bool ok = true;
+    double t = Measure([&] { ok = analyzer.ReadData(input); });
+    if (ok) {
+      results.push_back(
+          {"analyzer_read_compressed", config.readers, t, PeakRssKb()});
+      t = Measure([&] { analyzer.Analyze(); });
+      results.push_back(
+          {"analyzer_analyze_compressed", config.readers, t, PeakRssKb()});
+    }
+  }
+
+  {
+    // Все названия входного файла начинаются с заглавной буквы, то есть
+    // каждое переписывается: верхняя оценка цены нормализации.
+    BookAnalyzer analyzer;
+    analyzer.SetTitleNormalization(true);
+    analyzer.SetThreadCount(config.threads);
+    bool ok = true;
+    double t = Measure([&] { ok = analyzer.ReadData(input); });
+    if (ok) {
+      results.push_back(
+          {"analyzer_read_normalized", config.readers, t, PeakRssKb()});
+    }
+  }
+  std::remove(input.c_str());
+  std::remove(output.c_str());
+}
+
+void BenchCompetition(const BenchConfig &config,
+                      std::vector<BenchResult> &results) {
+  std::string input = config.dir + "/bench_competition.txt";
+  std::string output = config.dir + "/bench_competition_out.txt";
+  WriteCompetitionInput(config, input);
+
+  CompetitionOptions options;
+  options.max_athletes = config.athletes + 1;
+  QuietCout quiet;
+  bool ok = true;
+  double t = Measure([&] { ok = RunCompetition(input, output, options); });
+  if (ok) {
+    results.push_back({"competition_run", config.athletes * config.events, t,
+                       PeakRssKb()});
+  }
+  std::remove(input.c_str());
+  std::remove(output.c_str());
+}
+
+/// <summary>Печатает результаты в JSON: одна запись на замер.</summary>
+void PrintJson(const BenchConfig &config,
+               const std::vector<BenchResult> &results) {
+  std::printf("{\n  \"config\": {\"seed\": %llu, \"set_ops\": %zu, "
+              "\"titles\": %zu, \"readers\": %zu, \"books_per_reader\": %zu, "
+              "\"athletes\": %zu, \"events\": %zu, \"threads\": %zu},\n",
+              static_cast<unsigned long long>(config.seed), config.set_ops,
+              config.titles, config.readers, config.books_per_reader,
+              config.athletes, config.events, config.threads);
+  std::printf("  \"results\": [\n");
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const BenchResult &r = results[i];
+    double ns_per_op = r.ops == 0 ? 0.0 : r.seconds * 1e9 / r.ops;
+    double ops_per_sec = r.seconds > 0.0 ? r.ops / r.seconds : 0.0;
+    std::printf("    {\"name\": \"%s\", \"ops\": %zu, \"seconds\": %.6f, "
+                "\"ns_per_op\": %.2f, \"ops_per_sec\": %.0f, "
+                "\"peak_rss_kb\": %ld}%s\n",
+                r.name.c_str(), r.ops, r.seconds, ns_per_op, ops_per_sec,
+                r.peak_rss_kb, i + 1 < results.size() ? "," : "");
+  }
+  std::printf("  ]\n}\n");
+}
+
+/// <summary>Разбирает неотрицательное целое число из аргумента.</summary>
+/// <param name="text">Аргумент командной строки.</param>
+/// <param name="value">Результат.</param>
+/// <returns>false, если аргумент не число целиком (strtoull молча
+/// возвращает 0 для любого мусора).</returns>
+bool ParseCount(const char *text, std::size_t &value) {
+  if (*text < '0' || *text > '9')
+    return false;
+  errno = 0;
+  char *end = nullptr;
+  unsigned long long parsed = std::strtoull(text, &end, 10);
+  if (errno != 0 || *end != '\0')
+    return false;
+  value = static_cast<std::size_t>(parsed);
+  return true;
+}
+
+void PrintUsage() {
+  std::cerr << "Использование: benchmark [--seed S] [--set-ops N] "
+               "[--titles N] [--readers N] [--books-per-reader K] "
+               "[--athletes N] [--events M] [--threads T] [--dir DIR] "
+               "[--only set|dict|concurrent|analyzer|competition] "
+               "[--metrics FILE]\n";
+}
+
+} // namespace
+
+/// <summary>Набор замеров производительности контейнеров, анализа книг и
+/// многоборья на синтетических данных с фиксированным зерном.</summary>
+/// <returns>0 — успешно, 2 — ошибка в аргументах.</returns>
+/// <remarks>Результаты (ns/op, операций в секунду, пиковый RSS) выводятся в
+/// stdout в формате JSON. При сборке с ENABLE_METRICS ключ --metrics
+/// сохраняет счетчики и время этапов за весь прогон.</remarks>
+int main(int argc, char **argv) {
+  BenchConfig config;
+  std::string only;
+  std::string metrics_file;
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (i + 1 >= argc) {
+      PrintUsage();
+      return 2;
+    }
+    const char *value = argv[++i];
+    // Размеры данных должны быть положительными; число спортсменов, видов и
+    // потоков (0 — по числу аппаратных) может быть нулем.
+    bool ok = true;
+    auto count = [&ok, value](std::size_t &target, bool positive) {
+      ok = ParseCount(value, target) && (!positive || target != 0);
+    };
+    if (std::strcmp(arg, "--seed") == 0) {
+      std::size_t seed = 0;
+      count(seed, false);
+      config.seed = seed;
+    } else if (std::strcmp(arg, "--set-ops") == 0)
+      count(config.set_ops, true);
+    else if (std::strcmp(arg, "--titles") == 0)
+      count(config.titles, true);
+    else if (std::strcmp(arg, "--readers") == 0)
+      count(config.readers, true);
+    else if (std::strcmp(arg, "--books-per-reader") == 0)
+      count(config.books_per_reader, true);
+    else if (std::strcmp(arg, "--athletes") == 0)
+      count(config.athletes, false);
+    else if (std::strcmp(arg, "--events") == 0)
+      count(config.events, false);
+    else if (std::strcmp(arg, "--threads") == 0)
+      count(config.threads, false);
+    else if (std::strcmp(arg, "--dir") == 0)
+      config.dir = value;
+    else if (std::strcmp(arg, "--only") == 0)
+      only = value;
+    else if (std::strcmp(arg, "--metrics") == 0)
+      metrics_file = value;
+    else
+      ok = false;
+    if (!ok) {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  std::vector<BenchResult> results;
+  if (only.empty() || only == "set") {
+    BenchSetInt(config, results);
+    BenchSetString(config, results);
+    BenchSetAllocators(config, results);
+  }
+  if (only.empty() || only == "dict")
+    BenchDictionary(config, results);
+  if (only.empty() || only == "concurrent")
+    BenchConcurrent(config, results);
+  if (only.empty() || only == "analyzer")
+    BenchAnalyzer(config, results);
+  if (only.empty() || only == "competition")
+    BenchCompetition(config, results);
+
+  PrintJson(config, results);
+  if (!metrics_file.empty() && !WriteMetricsJson(metrics_file)) {
+    std::cerr << "Метрики не записаны: программа собрана без ENABLE_METRICS "
+                 "или файл недоступен\n";
+  }
+  return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef BIT_OPS_H_
+#define BIT_OPS_H_
+
+#include <cstdint>
+
+/// <summary>Количество установленных битов слова.</summary>
+/// <param name="word">Слово.</param>
+/// <returns>Число единичных битов.</returns>
+inline std::uint32_t PopCount(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::uint32_t>(__builtin_popcountll(word));
+#else
+  std::uint32_t count = 0;
+  while (word != 0) {
+    word &= word - 1;
+    ++count;
+  }
+  return count;
+#endif
+}
+
+/// <summary>Номер младшего установленного бита.</summary>
+/// <param name="word">Слово; не должно быть нулем.</param>
+/// <returns>Число нулевых битов перед младшей единицей.</returns>
+inline std::uint32_t CountTrailingZeros(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::uint32_t>(__builtin_ctzll(word));
+#else
+  std::uint32_t count = 0;
+  while ((word & 1) == 0) {
+    word >>= 1;
+    ++count;
+  }
+  return count;
+#endif
+}
+
+#endif // BIT_OPS_H_
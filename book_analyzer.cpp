@@ -0,0 +1,821 @@
+#include "book_analyzer.h"
+
+#include "dense_bitset.h"
+#include "mapped_file.h"
+#include "metrics.h"
+#include "sorted_set.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+/// Кусок раздела читателей меньше этого размера не делится дальше.
+constexpr std::size_t kMinChunkBytes = 64 * 1024;
+
+/// Признак номера из локального пула куска (иначе — номер из titles_).
+constexpr std::uint32_t kLocalTitle = 0x80000000u;
+
+/// Результат разбора одного куска раздела читателей.
+struct ReaderChunk {
+  std::string_view text;
+  /// Названия, которых не было в каталоге на момент разбора.
+  StringPool new_titles;
+  /// Закодированные названия всех читателей куска подряд.
+  std::vector<std::uint32_t> codes;
+  /// Конец списка каждого читателя в codes.
+  std::vector<std::size_t> reader_ends;
+  /// Глобальные номера названий из new_titles.
+  std::vector<StringId> remap;
+};
+
+/// Название в том виде, в котором оно хранится: нормализованное, если
+/// normalize (тогда результат может ссылаться на buffer).
+std::string_view StoredTitle(std::string_view title, bool normalize,
+                             std::string &buffer) {
+  return normalize ? NormalizeTitle(title, buffer) : title;
+}
+
+/// Разбирает кусок, только читая общий пул названий.
+void ParseReaderChunk(const StringPool &titles, bool normalize,
+                      ReaderChunk &chunk) {
+  std::string_view rest = chunk.text;
+  std::string_view line;
+  std::vector<std::string_view> books;
+  std::string buffer;
+  while (NextLine(rest, line)) {
+    METRICS_ADD(kLinesParsed, 1);
+    std::string_view trimmed = Trim(line);
+    if (trimmed.empty())
+      continue;
+    Split(trimmed, ';', books);
+    METRICS_ADD(kTokens, books.size());
+    for (std::string_view book : books) {
+      book = StoredTitle(book, normalize, buffer);
+      StringId id = titles.Find(book);
+      chunk.codes.push_back(id != StringPool::kNoString
+                                ? id
+                                : kLocalTitle | chunk.new_titles.Intern(book));
+    }
+    chunk.reader_ends.push_back(chunk.codes.size());
+  }
+}
+
+/// Книги множества в виде отрезка.
+TitleSpan SpanOf(const BookSet &books) {
+  return TitleSpan{books.begin(), books.Size()};
+}
+
+/// Отрезок над номерами из вектора.
+TitleSpan SpanOf(const std::vector<StringId> &books) {
+  return TitleSpan{books.data(), books.size()};
+}
+
+/// Сжатое множество книг читателя.
+RoaringBitmap CompressBooks(TitleSpan books) {
+  std::vector<StringId> sorted(books.data, books.data + books.size);
+  std::sort(sorted.begin(), sorted.end());
+  RoaringBitmap result = RoaringBitmap::FromSorted(sorted.data(), sorted.size());
+  result.RunOptimize();
+  return result;
+}
+
+} // namespace
+
+BookAnalyzer::BookAnalyzer() = default;
+
+BookAnalyzer::~BookAnalyzer() = default;
+
+bool BookAnalyzer::ReadData(const std::string &filename) {
+  METRICS_PHASE(kReadData);
+  MaterializeSnapshot();
+  MappedFile file;
+  if (!file.Open(filename)) {
+    std::cerr << "Ошибка: не удалось открыть файл " << filename << std::endl;
+    return false;
+  }
+
+  // Файл разбирается прямо в отображенной памяти: строки и названия —
+  // std::string_view, копируется только текст новых названий в titles_.
+  std::string_view rest = file.Data();
+  std::string_view line;
+  std::string buffer;
+
+  while (NextLine(rest, line)) {
+    METRICS_ADD(kLinesParsed, 1);
+    std::string_view trimmed = Trim(line);
+
+    if (trimmed.empty()) {
+      break;
+    }
+
+    METRICS_ADD(kTokens, 1);
+    all_books_.Add(
+        titles_.Intern(StoredTitle(trimmed, normalize_titles_, buffer)));
+  }
+
+  if (pool_) {
+    ReadReadersParallel(rest);
+  } else {
+    ReadReaders(rest);
+  }
+  if (storage_ == ReaderStorage::kCompressed)
+    CompressReaders();
+
+  file.Close();
+  results_ready_ = false;
+  index_ready_ = false;
+  // Счетчики инкрементального режима не знают новых названий и читателей:
+  // следующий Analyze строит их заново.
+  counts_.Reset(0);
+  incremental_ready_ = false;
+  return true;
+}
+
+void BookAnalyzer::ReadReaders(std::string_view text) {
+  std::string_view line;
+  std::vector<std::string_view> books;
+  std::string buffer;
+
+  while (NextLine(text, line)) {
+    METRICS_ADD(kLinesParsed, 1);
+    std::string_view trimmed = Trim(line);
+
+    if (trimmed.empty()) {
+      continue;
+    }
+
+    BookSet reader_books{ArenaAllocator<StringId>(&readers_arena_)};
+    Split(trimmed, ';', books);
+    METRICS_ADD(kTokens, books.size());
+    // Множество сразу получает место под все названия строки: без
+    // промежуточных перевыделений при росте.
+    reader_books.Reserve(books.size());
+
+    for (std::string_view book : books) {
+      StringId id =
+          titles_.Intern(StoredTitle(book, normalize_titles_, buffer));
+      reader_books.Add(id);
+      all_books_.Add(id);
+    }
+
+    readers_books_.push_back(std::move(reader_books));
+  }
+}
+
+void BookAnalyzer::ReadReadersParallel(std::string_view text) {
+  // Делим текст на куски, выравнивая границы по переводам строк.
+  std::size_t chunk_count = pool_->ThreadCount() * 4;
+  if (chunk_count > text.size() / kMinChunkBytes + 1)
+    chunk_count = text.size() / kMinChunkBytes + 1;
+  std::vector<ReaderChunk> chunks(chunk_count);
+  std::size_t begin = 0;
+  for (std::size_t c = 0; c < chunk_count; ++c) {
+    std::size_t end = text.size() * (c + 1) / chunk_count;
+    if (end < begin)
+      end = begin;
+    if (c + 1 < chunk_count) {
+      std::size_t newline = text.find('\n', end);
+      end = newline == std::string_view::npos ? text.size() : newline + 1;
+    }
+    chunks[c].text = text.substr(begin, end - begin);
+    begin = end;
+  }
+
+  // 1. Параллельный разбор: titles_ в это время только читается.
+  pool_->ParallelFor(chunk_count, [this, &chunks](std::size_t c) {
+    ParseReaderChunk(titles_, normalize_titles_, chunks[c]);
+  });
+
+  // 2. Последовательное слияние новых названий в порядке кусков: номера
+  //    выдаются в порядке первого появления, как при однопоточном разборе.
+  for (auto &chunk : chunks) {
+    chunk.remap.resize(chunk.new_titles.Size());
+    for (std::size_t i = 0; i < chunk.remap.size(); ++i) {
+      chunk.remap[i] =
+          titles_.Intern(chunk.new_titles.View(static_cast<StringId>(i)));
+    }
+  }
+  // Каталог — это ровно все интернированные названия в порядке номеров.
+  for (std::size_t id = all_books_.Size(); id < titles_.Size(); ++id) {
+    all_books_.Add(static_cast<StringId>(id));
+  }
+
+  // 3. Множества читателей создаются в арене последовательно (арена не
+  //    потокобезопасна) сразу с точной емкостью, затем параллельно
+  //    заполняются глобальными номерами — уже без выделения памяти.
+  ArenaAllocator<StringId> allocator(&readers_arena_);
+  std::vector<std::size_t> first_reader(chunk_count);
+  std::size_t reader_count = readers_books_.size();
+  for (const auto &chunk : chunks)
+    reader_count += chunk.reader_ends.size();
+  readers_books_.reserve(reader_count);
+  for (std::size_t c = 0; c < chunk_count; ++c) {
+    first_reader[c] = readers_books_.size();
+    std::size_t start = 0;
+    for (std::size_t end : chunks[c].reader_ends) {
+      readers_books_.emplace_back(allocator);
+      readers_books_.back().Reserve(end - start);
+      start = end;
+    }
+  }
+
+  pool_->ParallelFor(chunk_count, [&](std::size_t c) {
+    const ReaderChunk &chunk = chunks[c];
+    std::size_t start = 0;
+    for (std::size_t r = 0; r < chunk.reader_ends.size(); ++r) {
+      BookSet &reader = readers_books_[first_reader[c] + r];
+      for (std::size_t i = start; i < chunk.reader_ends[r]; ++i) {
+        std::uint32_t code = chunk.codes[i];
+        reader.Add((code & kLocalTitle) != 0 ? chunk.remap[code & ~kLocalTitle]
+                                             : code);
+      }
+      start = chunk.reader_ends[r];
+    }
+  });
+}
+
+void BookAnalyzer::Analyze() {
+  METRICS_PHASE(kAnalyze);
+  if (snapshot_) {
+    // Категории из снимка уже вычислены; инкрементальному режиму нужны
+    // счетчики, а их строят по множествам читателей.
+    if (results_ready_ && mode_ != AnalysisMode::kIncremental)
+      return;
+    MaterializeSnapshot();
+  }
+  if (ReaderCount() == 0) {
+    std::cout << "Нет данных о читателях" << std::endl;
+    // В инкрементальном режиме индекс нужен и без читателей: они могут
+    // появиться позже через AddReader.
+    if (mode_ == AnalysisMode::kIncremental)
+      AnalyzeIncremental();
+    results_ready_ = incremental_ready_;
+    return;
+  }
+
+  if (mode_ == AnalysisMode::kIncremental) {
+    AnalyzeIncremental();
+  } else if (storage_ == ReaderStorage::kCompressed) {
+    AnalyzeCompressed();
+  } else if (mode_ == AnalysisMode::kBitset) {
+    AnalyzeBitset();
+  } else if (mode_ == AnalysisMode::kSorted) {
+    AnalyzeSorted();
+  } else {
+    AnalyzeSets();
+  }
+  results_ready_ = true;
+}
+
+void BookAnalyzer::AnalyzeSets() {
+  const BookSet *first = readers_books_.data();
+  const BookSet *last = first + readers_books_.size();
+
+  books_read_by_all_ = BookSet::IntersectAll(first, last, pool_.get());
+
+  books_read_by_someone_ = BookSet::UnionAll(first, last, pool_.get());
+
+  books_read_by_some_ = books_read_by_someone_;
+  books_read_by_some_.ExceptWith(books_read_by_all_);
+
+  books_read_by_none_ = all_books_;
+  books_read_by_none_.ExceptWith(books_read_by_someone_);
+}
+
+void BookAnalyzer::AnalyzeSorted() {
+  const BookSet *first = readers_books_.data();
+  const BookSet *last = first + readers_books_.size();
+
+  // «Все» не больше самого маленького читателя: он задает начальное
+  // множество, которое затем только сжимается. Остальные читатели уже
+  // хешированы, поэтому проверка каждого стоит O(размера пересечения), а не
+  // сортировку читателя.
+  const BookSet *smallest = first;
+  for (const BookSet *reader = first; reader != last; ++reader) {
+    if (reader->Size() < smallest->Size())
+      smallest = reader;
+  }
+  SortedSet<StringId> by_all(*smallest);
+  for (const BookSet *reader = first; reader != last && !by_all.IsEmpty();
+       ++reader) {
+    if (reader != smallest)
+      by_all.IntersectWith(*reader);
+  }
+
+  SortedSet<StringId> by_someone(BookSet::UnionAll(first, last, pool_.get()));
+  SortedSet<StringId> by_some = by_someone.Except(by_all);
+  // all_books_ заполнен в порядке номеров: преобразование без сортировки.
+  SortedSet<StringId> by_none(all_books_);
+  by_none.ExceptWith(by_someone);
+
+  auto to_set = [](const SortedSet<StringId> &books) {
+    BookSet result;
+    result.Reserve(books.Size());
+    for (StringId id : books)
+      result.Add(id);
+    return result;
+  };
+  books_read_by_all_ = to_set(by_all);
+  books_read_by_someone_ = to_set(by_someone);
+  books_read_by_some_ = to_set(by_some);
+  books_read_by_none_ = to_set(by_none);
+}
+
+void BookAnalyzer::AnalyzeBitset() {
+  // Плотные номера книг — их StringId: ReadData интернирует каждое название
+  // и добавляет его в all_books_, поэтому номера 0..Size()-1 и есть каталог.
+  std::size_t catalog_size = titles_.Size();
+
+  // Битовое множество читателя строится в одном рабочем буфере и сразу
+  // сворачивается в «все» (AND) и «хоть кто-то» (OR).
+  DenseBitset by_all(catalog_size);
+  DenseBitset by_someone(catalog_size);
+  DenseBitset reader(catalog_size);
+  by_all.SetAll();
+  for (const auto &reader_books : readers_books_) {
+    reader.ResetAll();
+    for (StringId id : reader_books) {
+      reader.Set(id);
+    }
+    by_all.AndWith(reader);
+    by_someone.OrWith(reader);
+  }
+
+  DenseBitset by_some = by_someone;
+  by_some.AndNotWith(by_all);
+  DenseBitset by_none(catalog_size);
+  by_none.SetAll();
+  by_none.AndNotWith(by_someone);
+
+  auto to_set = [](const DenseBitset &bits) {
+    BookSet result;
+    for (std::size_t id : bits.ToIndices()) {
+      result.Add(static_cast<StringId>(id));
+    }
+    return result;
+  };
+  books_read_by_all_ = to_set(by_all);
+  books_read_by_someone_ = to_set(by_someone);
+  books_read_by_some_ = to_set(by_some);
+  books_read_by_none_ = to_set(by_none);
+}
+
+void BookAnalyzer::AnalyzeCompressed() {
+  // Как в kSorted, пересечение начинается с самого маленького читателя и
+  // прекращается, как только становится пустым.
+  const RoaringBitmap *smallest = &compressed_readers_.front();
+  for (const RoaringBitmap &reader : compressed_readers_) {
+    if (reader.Count() < smallest->Count())
+      smallest = &reader;
+  }
+  RoaringBitmap by_all = *smallest;
+  for (const RoaringBitmap &reader : compressed_readers_) {
+    if (by_all.None())
+      break;
+    if (&reader != smallest)
+      by_all.AndWith(reader);
+  }
+
+  RoaringBitmap by_someone;
+  for (const RoaringBitmap &reader : compressed_readers_)
+    by_someone.OrWith(reader);
+  RoaringBitmap by_some = by_someone;
+  by_some.AndNotWith(by_all);
+
+  // Каталог — номера 0..Size()-1 (см. AnalyzeBitset); после RunOptimize это
+  // один отрезок на каждые 65536 названий.
+  std::vector<StringId> catalog(titles_.Size());
+  std::iota(catalog.begin(), catalog.end(), StringId{0});
+  RoaringBitmap by_none = RoaringBitmap::FromSorted(catalog.data(), catalog.size());
+  by_none.RunOptimize();
+  by_none.AndNotWith(by_someone);
+
+  auto to_set = [](const RoaringBitmap &bits) {
+    BookSet result;
+    result.Reserve(bits.Count());
+    bits.ForEach([&result](std::uint32_t id) { result.Add(id); });
+    return result;
+  };
+  books_read_by_all_ = to_set(by_all);
+  books_read_by_someone_ = to_set(by_someone);
+  books_read_by_some_ = to_set(by_some);
+  books_read_by_none_ = to_set(by_none);
+}
+
+void BookAnalyzer::AnalyzeIncremental() {
+  counts_.Reset(titles_.Size());
+  std::vector<StringId> buffer;
+  for (std::size_t r = 0; r < ReaderCount(); ++r)
+    counts_.AddReader(ReaderBooks(r, buffer));
+  incremental_ready_ = true;
+}
+
+std::size_t BookAnalyzer::AddReader(const std::vector<std::string> &books) {
+  MaterializeSnapshot();
+  bool compressed = storage_ == ReaderStorage::kCompressed;
+  // Сжимаемое множество временное: оно берет память из кучи, а не из арены.
+  BookSet reader_books{
+      ArenaAllocator<StringId>(compressed ? nullptr : &readers_arena_)};
+  reader_books.Reserve(books.size());
+  std::string buffer;
+  for (const auto &book : books) {
+    std::size_t known = titles_.Size();
+    StringId id = titles_.Intern(StoredTitle(book, normalize_titles_, buffer));
+    if (id >= known) {
+      all_books_.Add(id);
+      if (incremental_ready_)
+        counts_.AddTitle();
+      if (index_ready_)
+        reader_index_.AddTitle();
+    }
+    reader_books.Add(id);
+  }
+  if (incremental_ready_)
+    counts_.AddReader(SpanOf(reader_books));
+  if (index_ready_)
+    reader_index_.AddReader(SpanOf(reader_books));
+  if (compressed)
+    compressed_readers_.push_back(CompressBooks(SpanOf(reader_books)));
+  else
+    readers_books_.push_back(std::move(reader_books));
+  results_ready_ = incremental_ready_;
+  return ReaderCount() - 1;
+}
+
+bool BookAnalyzer::RemoveReader(std::size_t reader) {
+  MaterializeSnapshot();
+  if (reader >= ReaderCount())
+    return false;
+  std::vector<StringId> buffer;
+  std::vector<StringId> last_buffer;
+  TitleSpan books = ReaderBooks(reader, buffer);
+  if (incremental_ready_)
+    counts_.RemoveReader(books);
+  if (index_ready_) {
+    reader_index_.RemoveReader(reader, books,
+                               ReaderBooks(ReaderCount() - 1, last_buffer));
+  }
+  if (storage_ == ReaderStorage::kCompressed) {
+    if (reader + 1 != compressed_readers_.size())
+      compressed_readers_[reader] = std::move(compressed_readers_.back());
+    compressed_readers_.pop_back();
+  } else {
+    if (reader + 1 != readers_books_.size())
+      readers_books_[reader] = std::move(readers_books_.back());
+    readers_books_.pop_back();
+  }
+  results_ready_ = incremental_ready_;
+  return true;
+}
+
+TitleSpan BookAnalyzer::CategoryBooks(int category) const {
+  if (snapshot_)
+    return snapshot_->Category(category);
+  if (mode_ == AnalysisMode::kIncremental && incremental_ready_) {
+    if (category == 0)
+      return counts_.ReadByAll();
+    if (category == 1)
+      return counts_.ReadBySome();
+    return counts_.ReadByNone();
+  }
+  return SpanOf(category == 0   ? books_read_by_all_
+                : category == 1 ? books_read_by_some_
+                                : books_read_by_none_);
+}
+
+bool BookAnalyzer::SaveSnapshot(const std::string &filename) const {
+  METRICS_PHASE(kSaveSnapshot);
+  SnapshotWriter writer;
+  std::size_t title_count =
+      snapshot_ ? snapshot_->TitleCount() : titles_.Size();
+  for (std::size_t id = 0; id < title_count; ++id)
+    writer.AddTitle(TitleOf(static_cast<StringId>(id)));
+  writer.SetCatalog(snapshot_ ? snapshot_->Catalog() : SpanOf(all_books_));
+  // Снимок хранит списки номеров: сжатые множества разворачиваются, и
+  // развернутые списки должны дожить до Save.
+  std::vector<std::vector<StringId>> expanded;
+  expanded.reserve(compressed_readers_.size());
+  for (std::size_t r = 0; r < ReaderCount(); ++r) {
+    if (snapshot_) {
+      writer.AddReader(snapshot_->ReaderBooks(r));
+    } else if (storage_ == ReaderStorage::kCompressed) {
+      expanded.push_back(compressed_readers_[r].ToIndices());
+      writer.AddReader(SpanOf(expanded.back()));
+    } else {
+      writer.AddReader(SpanOf(readers_books_[r]));
+    }
+  }
+  if (results_ready_)
+    writer.SetResults(CategoryBooks(0), CategoryBooks(1), CategoryBooks(2));
+  if (!writer.Save(filename)) {
+    std::cerr << "Ошибка: не удалось записать снимок " << filename
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+std::vector<BookQueryResult>
+BookAnalyzer::RunQueries(const std::vector<BookQuery> &queries) {
+  METRICS_PHASE(kQueries);
+  MaterializeSnapshot();
+  if (!index_ready_)
+    BuildReaderIndex();
+  std::vector<BookQueryResult> results(queries.size());
+  // Запросы только читают индекс и множества, поэтому независимы.
+  if (pool_) {
+    pool_->ParallelFor(queries.size(), [&](std::size_t q) {
+      AnswerQuery(queries[q], results[q]);
+    });
+  } else {
+    for (std::size_t q = 0; q < queries.size(); ++q)
+      AnswerQuery(queries[q], results[q]);
+  }
+  return results;
+}
+
+void BookAnalyzer::BuildReaderIndex() {
+  reader_index_.Reset(titles_.Size());
+  std::vector<StringId> buffer;
+  for (std::size_t r = 0; r < ReaderCount(); ++r)
+    reader_index_.AddReader(ReaderBooks(r, buffer));
+  index_ready_ = true;
+}
+
+void BookAnalyzer::AnswerQuery(const BookQuery &query,
+                               BookQueryResult &result) const {
+  if (query.kind == BookQuery::Kind::kReadersOf) {
+    std::string buffer;
+    StringId id =
+        titles_.Find(StoredTitle(query.title, normalize_titles_, buffer));
+    if (id == StringPool::kNoString)
+      return;
+    ReaderSpan readers = reader_index_.ReadersOf(id);
+    result.readers.assign(readers.data, readers.data + readers.size);
+    return;
+  }
+
+  if (query.kind == BookQuery::Kind::kReadByAtLeast) {
+    TitleSpan books = reader_index_.ReadByAtLeast(query.min_readers);
+    result.titles.reserve(books.size);
+    for (std::size_t i = 0; i < books.size; ++i)
+      result.titles.push_back(titles_.View(books.data[i]));
+    return;
+  }
+
+  std::vector<std::size_t> group(query.readers);
+  std::sort(group.begin(), group.end());
+  group.erase(std::unique(group.begin(), group.end()), group.end());
+  if (group.empty() || group.back() >= ReaderCount())
+    return;
+  // Ответ не больше самого маленького читателя: его книги — кандидаты.
+  // Остальные проверяются от меньших к большим, чтобы кандидат отсеивался
+  // как можно раньше; книги, у которых читателей меньше, чем в группе,
+  // отбрасываются без поиска.
+  std::sort(group.begin(), group.end(), [this](std::size_t a, std::size_t b) {
+    return ReaderSize(a) < ReaderSize(b);
+  });
+  std::vector<StringId> buffer;
+  TitleSpan candidates = ReaderBooks(group.front(), buffer);
+  std::vector<StringId> found;
+  for (std::size_t i = 0; i < candidates.size; ++i) {
+    StringId id = candidates.data[i];
+    if (reader_index_.ReadersOf(id).size < group.size())
+      continue;
+    bool read_by_all = true;
+    for (std::size_t g = 1; g < group.size() && read_by_all; ++g)
+      read_by_all = reader_index_.HasRead(group[g], id);
+    if (read_by_all)
+      found.push_back(id);
+  }
+  std::sort(found.begin(), found.end());
+  result.titles.reserve(found.size());
+  for (StringId id : found)
+    result.titles.push_back(titles_.View(id));
+}
+
+bool BookAnalyzer::LoadSnapshot(const std::string &filename) {
+  METRICS_PHASE(kLoadSnapshot);
+  std::unique_ptr<BookSnapshot> snapshot(new BookSnapshot());
+  std::string error;
+  if (!snapshot->Open(filename, error)) {
+    std::cerr << "Ошибка: " << error << std::endl;
+    return false;
+  }
+  ResetData();
+  snapshot_ = std::move(snapshot);
+  results_ready_ = snapshot_->HasResults();
+  return true;
+}
+
+void BookAnalyzer::MaterializeSnapshot() {
+  if (!snapshot_)
+    return;
+  const BookSnapshot &snapshot = *snapshot_;
+  // Названия в снимке различны и идут по порядку номеров, поэтому Intern
+  // выдает те же номера.
+  for (std::size_t id = 0; id < snapshot.TitleCount(); ++id)
+    titles_.Intern(snapshot.Title(static_cast<StringId>(id)));
+
+  auto fill = [](BookSet &set, TitleSpan books) {
+    set.Reserve(books.size);
+    for (std::size_t i = 0; i < books.size; ++i)
+      set.Add(books.data[i]);
+  };
+  fill(all_books_, snapshot.Catalog());
+  readers_books_.reserve(snapshot.ReaderCount());
+  for (std::size_t r = 0; r < snapshot.ReaderCount(); ++r) {
+    readers_books_.emplace_back(ArenaAllocator<StringId>(&readers_arena_));
+    fill(readers_books_.back(), snapshot.ReaderBooks(r));
+  }
+  if (storage_ == ReaderStorage::kCompressed)
+    CompressReaders();
+  if (snapshot.HasResults()) {
+    fill(books_read_by_all_, snapshot.Category(0));
+    fill(books_read_by_some_, snapshot.Category(1));
+    fill(books_read_by_none_, snapshot.Category(2));
+    books_read_by_someone_ = books_read_by_all_.Union(books_read_by_some_);
+  }
+  snapshot_.reset();
+}
+
+void BookAnalyzer::CompressReaders() {
+  compressed_readers_.reserve(compressed_readers_.size() +
+                              readers_books_.size());
+  for (const BookSet &reader_books : readers_books_)
+    compressed_readers_.push_back(CompressBooks(SpanOf(reader_books)));
+  readers_books_.clear();
+  readers_books_.shrink_to_fit();
+  readers_arena_.Release();
+}
+
+void BookAnalyzer::ExpandReaders() {
+  readers_books_.reserve(readers_books_.size() + compressed_readers_.size());
+  for (const RoaringBitmap &reader : compressed_readers_) {
+    readers_books_.emplace_back(ArenaAllocator<StringId>(&readers_arena_));
+    BookSet &reader_books = readers_books_.back();
+    reader_books.Reserve(reader.Count());
+    reader.ForEach([&reader_books](std::uint32_t id) { reader_books.Add(id); });
+  }
+  compressed_readers_.clear();
+  compressed_readers_.shrink_to_fit();
+}
+
+void BookAnalyzer::ResetData() {
+  snapshot_.reset();
+  titles_.Clear();
+  all_books_.Clear();
+  readers_books_.clear();
+  compressed_readers_.clear();
+  readers_arena_.Release();
+  books_read_by_all_.Clear();
+  books_read_by_some_.Clear();
+  books_read_by_none_.Clear();
+  books_read_by_someone_.Clear();
+  counts_.Reset(0);
+  incremental_ready_ = false;
+  reader_index_.Reset(0);
+  index_ready_ = false;
+  results_ready_ = false;
+}
+
+std::string_view BookAnalyzer::TitleOf(StringId id) const {
+  return snapshot_ ? snapshot_->Title(id) : titles_.View(id);
+}
+
+std::size_t BookAnalyzer::CatalogSize() const {
+  return snapshot_ ? snapshot_->Catalog().size : all_books_.Size();
+}
+
+std::size_t BookAnalyzer::ReaderCount() const {
+  if (snapshot_)
+    return snapshot_->ReaderCount();
+  return storage_ == ReaderStorage::kCompressed ? compressed_readers_.size()
+                                                : readers_books_.size();
+}
+
+TitleSpan BookAnalyzer::ReaderBooks(std::size_t reader,
+                                    std::vector<StringId> &buffer) const {
+  if (storage_ == ReaderStorage::kCompressed) {
+    buffer = compressed_readers_[reader].ToIndices();
+    return SpanOf(buffer);
+  }
+  return SpanOf(readers_books_[reader]);
+}
+
+std::size_t BookAnalyzer::ReaderSize(std::size_t reader) const {
+  return storage_ == ReaderStorage::kCompressed
+             ? compressed_readers_[reader].Count()
+             : readers_books_[reader].Size();
+}
+
+void BookAnalyzer::PrintResults() const {
+  METRICS_PHASE(kSaveResults);
+  OutputSink out;
+  out.AddStdout();
+  WriteResults(out);
+}
+
+void BookAnalyzer::SaveResults(const std::string &filename) const {
+  METRICS_PHASE(kSaveResults);
+  OutputSink out;
+  if (!out.AddFile(filename)) {
+    std::cerr << "Ошибка: не удалось создать файл " << filename << std::endl;
+    return;
+  }
+  WriteResults(out);
+  out.Flush();
+  std::cout << "\nРезультаты сохранены в файл: " << filename << std::endl;
+}
+
+void BookAnalyzer::PrintAndSaveResults(const std::string &filename) const {
+  METRICS_PHASE(kSaveResults);
+  OutputSink out;
+  out.AddStdout();
+  bool saved = out.AddFile(filename);
+  WriteResults(out);
+  out.Flush();
+  if (saved) {
+    std::cout << "\nРезультаты сохранены в файл: " << filename << std::endl;
+  } else {
+    std::cerr << "Ошибка: не удалось создать файл " << filename << std::endl;
+  }
+}
+
+void BookAnalyzer::WriteResults(OutputSink &out) const {
+  out.Write("Всего книг в каталоге: ").Write(CatalogSize()).Write('\n');
+  out.Write("Количество читателей: ")
+      .Write(ReaderCount())
+      .Write("\n\n");
+
+  WriteSet(out, "Книги, прочитанные ВСЕМИ читателями:", CategoryBooks(0));
+  WriteSet(out, "Книги, прочитанные НЕКОТОРЫМИ читателями (но не всеми):",
+           CategoryBooks(1));
+  WriteSet(out, "Книги, которые НИКТО не прочитал:", CategoryBooks(2));
+}
+
+void BookAnalyzer::SetMode(AnalysisMode mode) {
+  // Категории инкрементального режима живут в counts_; остальные режимы
+  // выводят множества, которые могли устареть.
+  if (incremental_ready_ && mode != AnalysisMode::kIncremental)
+    results_ready_ = false;
+  mode_ = mode;
+  if (mode_ != AnalysisMode::kIncremental)
+    incremental_ready_ = false;
+}
+
+AnalysisMode BookAnalyzer::Mode() const { return mode_; }
+
+void BookAnalyzer::SetThreadCount(std::size_t thread_count) {
+  pool_.reset();
+  if (thread_count != 1) {
+    pool_.reset(new ThreadPool(thread_count));
+    if (pool_->ThreadCount() == 1)
+      pool_.reset();
+  }
+}
+
+std::size_t BookAnalyzer::ThreadCount() const {
+  return pool_ ? pool_->ThreadCount() : 1;
+}
+
+void BookAnalyzer::SetReaderStorage(ReaderStorage storage) {
+  if (storage == storage_)
+    return;
+  storage_ = storage;
+  // Снимок переводится в нужное представление при материализации.
+  if (storage_ == ReaderStorage::kCompressed)
+    CompressReaders();
+  else
+    ExpandReaders();
+}
+
+ReaderStorage BookAnalyzer::Storage() const { return storage_; }
+
+void BookAnalyzer::SetTitleNormalization(bool enabled) {
+  normalize_titles_ = enabled;
+}
+
+bool BookAnalyzer::TitleNormalization() const { return normalize_titles_; }
+
+void BookAnalyzer::WriteSet(OutputSink &out, std::string_view title,
+                            TitleSpan books) const {
+  out.Write(title).Write('\n');
+  out.Write("Количество: ").Write(books.size).Write('\n');
+
+  if (books.size == 0) {
+    out.Write("  (нет книг)\n\n");
+  } else {
+    for (std::size_t i = 0; i < books.size; ++i) {
+      out.Write("  • ").Write(TitleOf(books.data[i])).Write('\n');
+    }
+    out.Write('\n');
+  }
+}
@@ -0,0 +1,357 @@
+#ifndef BOOK_ANALYZER_H_
+#define BOOK_ANALYZER_H_
+
+#include "allocators.h"
+#include "output_sink.h"
+#include "reader_index.h"
+#include "roaring_bitmap.h"
+#include "snapshot.h"
+#include "string_pool.h"
+#include "title_count_index.h"
+#include "unordered_set.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>Множество книг (номеров названий).</summary>
+/// <remarks>Множества читателей получают аллокатор над ареной BookAnalyzer,
+/// остальные (каталог, категории, копии) — аллокатор по умолчанию, то есть
+/// обычную кучу. До kInlineBooks книг множество целиком лежит внутри объекта и
+/// не обращается к аллокатору: так хранится большинство читателей.</remarks>
+constexpr std::size_t kInlineBooks = 8;
+using BookSet =
+    UnorderedSet<StringId, std::hash<StringId>, std::equal_to<StringId>,
+                 ArenaAllocator<StringId>, kInlineBooks>;
+
+/// <summary>Способ вычисления категорий книг в BookAnalyzer::Analyze.</summary>
+enum class AnalysisMode {
+  /// <summary>Цепочки Intersect/Union над множествами названий.</summary>
+  kSets,
+  /// <summary>Каждой книге каталога присваивается плотный номер, каждый
+  /// читатель представляется битовым множеством над каталогом; категории
+  /// вычисляются пословными AND/OR/ANDNOT.</summary>
+  kBitset,
+  /// <summary>Analyze строит счетчики читателей по книгам (TitleCountIndex),
+  /// после чего AddReader/RemoveReader обновляют категории на месте за
+  /// O(число книг читателя).</summary>
+  kIncremental,
+  /// <summary>Категории хранятся отсортированными множествами (SortedSet).
+  /// Пересечение начинается с самого маленького читателя и проверяется по
+  /// хеш-таблицам остальных (читатели не сортируются); разности между
+  /// категориями — слияния, которые при перекосе размеров (несколько книг
+  /// «у всех» против всего прочитанного) переходят на галопирующий
+  /// поиск.</summary>
+  kSorted,
+};
+
+/// <summary>Способ хранения множеств книг читателей в BookAnalyzer.</summary>
+enum class ReaderStorage {
+  /// <summary>Хеш-множества BookSet в арене (по умолчанию).</summary>
+  kHashSets,
+  /// <summary>Сжатые множества RoaringBitmap над номерами названий: память
+  /// пропорциональна числу прочитанных книг (около двух байт на книгу), а не
+  /// размеру каталога. Категории в режимах kSets, kBitset и kSorted
+  /// вычисляются операциями AND/OR/ANDNOT над сжатыми множествами и
+  /// перечисляются в порядке каталога.</summary>
+  kCompressed,
+};
+
+/// <summary>Запрос к BookAnalyzer::RunQueries.</summary>
+struct BookQuery {
+  enum class Kind {
+    /// <summary>Читатели книги title.</summary>
+    kReadersOf,
+    /// <summary>Книги, прочитанные каждым читателем из readers.</summary>
+    kReadByGroup,
+    /// <summary>Книги, прочитанные не меньше чем min_readers
+    /// читателями.</summary>
+    kReadByAtLeast,
+  };
+
+  Kind kind = Kind::kReadersOf;
+  /// <summary>Название книги (kReadersOf).</summary>
+  std::string_view title;
+  /// <summary>Номера читателей группы (kReadByGroup); повторы
+  /// допускаются.</summary>
+  std::vector<std::size_t> readers;
+  /// <summary>Наименьшее число читателей (kReadByAtLeast).</summary>
+  std::size_t min_readers = 0;
+};
+
+/// <summary>Ответ на BookQuery.</summary>
+struct BookQueryResult {
+  /// <summary>kReadersOf: номера читателей по возрастанию.</summary>
+  std::vector<std::size_t> readers;
+  /// <summary>kReadByGroup: книги в порядке каталога; kReadByAtLeast: по
+  /// убыванию числа читателей. Названия указывают в пул анализатора и
+  /// действительны до LoadSnapshot или его уничтожения.</summary>
+  std::vector<std::string_view> titles;
+};
+
+/// <summary>Класс для анализа прочитанных книг читателями.</summary>
+/// <remarks>
+/// Использует класс UnorderedSet для хранения книг и выполнения операций над
+/// множествами. Определяет три категории книг: прочитанные всеми, прочитанные
+/// некоторыми, не прочитанные никем. Названия интернируются в StringPool:
+/// каждое хранится один раз, а множества содержат только StringId.
+/// Множества книг читателей размещаются в одной MonotonicArena: при разборе
+/// нет отдельного malloc/free на каждого читателя, а вся их память
+/// освобождается одним шагом вместе с анализатором.
+/// </remarks>
+class BookAnalyzer {
+public:
+  BookAnalyzer();
+  ~BookAnalyzer();
+
+  /// <summary>Читает данные из файла и заполняет внутренние
+  /// структуры.</summary> <param name="filename">Имя файла с данными.</param>
+  /// <returns>true, если данные успешно прочитаны, иначе false.</returns>
+  /// <remarks>При ThreadCount() > 1 раздел читателей разбирается параллельно
+  /// (см. SetThreadCount); результат совпадает с однопоточным разбором.</remarks>
+  bool ReadData(const std::string &filename);
+
+  /// <summary>Выполняет анализ прочитанных книг.</summary>
+  /// <remarks>
+  /// Определяет три категории книг:
+  /// 1. Книги, прочитанные всеми читателями
+  /// 2. Книги, прочитанные некоторыми читателями (но не всеми)
+  /// 3. Книги, которые никто не прочитал
+  /// Состав категорий не зависит от режима (SetMode); в режимах kBitset и
+  /// kSorted книги в каждой категории перечисляются в порядке каталога.
+  /// </remarks>
+  void Analyze();
+
+  /// <summary>Добавляет читателя.</summary>
+  /// <param name="books">Названия прочитанных книг; неизвестные названия
+  /// добавляются в каталог.</param>
+  /// <returns>Номер читателя.</returns>
+  /// <remarks>В режиме kIncremental после Analyze категории обновляются
+  /// сразу; в остальных режимах результаты устаревают до следующего
+  /// Analyze.</remarks>
+  std::size_t AddReader(const std::vector<std::string> &books);
+
+  /// <summary>Удаляет читателя.</summary>
+  /// <param name="reader">Номер читателя.</param>
+  /// <returns>true, если читатель был удален.</returns>
+  /// <remarks>Номер удаленного читателя получает последний читатель. В
+  /// режиме kIncremental после Analyze категории обновляются сразу. Память
+  /// множества остается в арене до уничтожения анализатора.</remarks>
+  bool RemoveReader(std::size_t reader);
+
+  /// <summary>Сохраняет состояние в двоичный снимок.</summary>
+  /// <param name="filename">Имя файла.</param>
+  /// <returns>true, если снимок записан.</returns>
+  /// <remarks>В снимок попадают каталог, названия и множества читателей, а
+  /// также категории, если после последнего Analyze данные не менялись (в
+  /// режиме kIncremental категории всегда актуальны).</remarks>
+  bool SaveSnapshot(const std::string &filename) const;
+
+  /// <summary>Загружает состояние из снимка, заменяя текущее.</summary>
+  /// <param name="filename">Имя файла, записанного SaveSnapshot.</param>
+  /// <returns>true, если снимок загружен.</returns>
+  /// <remarks>Файл отображается в память и используется на месте: вывод
+  /// результатов, сохраненных в снимке, не требует разбора и построения
+  /// контейнеров. Множества и пул названий строятся из снимка только при
+  /// первом изменении (ReadData, AddReader, RemoveReader) или Analyze, если
+  /// результатов в снимке нет или выбран режим kIncremental. Категории из
+  /// снимка выводятся в сохраненном порядке.</remarks>
+  bool LoadSnapshot(const std::string &filename);
+
+  /// <summary>Отвечает на пакет запросов о том, кто какие книги
+  /// читал.</summary>
+  /// <param name="queries">Запросы.</param>
+  /// <returns>Ответы в порядке запросов.</returns>
+  /// <remarks>Первый вызов строит обратный индекс ReaderIndex (книга —
+  /// список читателей) за O(суммарного числа книг читателей); дальше
+  /// AddReader и RemoveReader обновляют его на месте, а ReadData и
+  /// LoadSnapshot сбрасывают. По индексу kReadersOf и kReadByAtLeast
+  /// отвечаются за O(размера ответа), kReadByGroup — перебором книг самого
+  /// маленького читателя группы с проверкой остальных по спискам читателей.
+  /// Неизвестное название или номер читателя вне диапазона дают пустой
+  /// ответ. При ThreadCount() > 1 запросы обрабатываются
+  /// параллельно.</remarks>
+  std::vector<BookQueryResult> RunQueries(const std::vector<BookQuery> &queries);
+
+  /// <summary>Выводит результаты анализа в консоль.</summary>
+  void PrintResults() const;
+
+  /// <summary>Сохраняет результаты анализа в файл.</summary>
+  /// <param name="filename">Имя файла для сохранения результатов.</param>
+  void SaveResults(const std::string &filename) const;
+
+  /// <summary>Выводит результаты в консоль и сохраняет их в файл.</summary>
+  /// <param name="filename">Имя файла для сохранения результатов.</param>
+  /// <remarks>Равносильно PrintResults и SaveResults, но текст форматируется
+  /// один раз и отправляется обоим получателям.</remarks>
+  void PrintAndSaveResults(const std::string &filename) const;
+
+  /// <summary>Задает способ вычисления категорий.</summary>
+  /// <param name="mode">Режим анализа (по умолчанию kSets).</param>
+  void SetMode(AnalysisMode mode);
+
+  /// <summary>Возвращает текущий способ вычисления категорий.</summary>
+  /// <returns>Режим анализа.</returns>
+  AnalysisMode Mode() const;
+
+  /// <summary>Задает число потоков для разбора и анализа.</summary>
+  /// <param name="thread_count">Число потоков (по умолчанию 1); 0 — по числу
+  /// аппаратных потоков.</param>
+  void SetThreadCount(std::size_t thread_count);
+
+  /// <summary>Возвращает число потоков для разбора и анализа.</summary>
+  /// <returns>Число потоков.</returns>
+  std::size_t ThreadCount() const;
+
+  /// <summary>Задает способ хранения множеств читателей.</summary>
+  /// <param name="storage">Способ хранения (по умолчанию kHashSets).</param>
+  /// <remarks>Уже прочитанные читатели переводятся в новое представление;
+  /// категории при этом остаются актуальными.</remarks>
+  void SetReaderStorage(ReaderStorage storage);
+
+  /// <summary>Возвращает способ хранения множеств читателей.</summary>
+  /// <returns>Способ хранения.</returns>
+  ReaderStorage Storage() const;
+
+  /// <summary>Включает нормализацию названий (NormalizeTitle) при
+  /// чтении.</summary>
+  /// <param name="enabled">true — нормализовать (по умолчанию false).</param>
+  /// <remarks>Названия из ReadData и AddReader и названия в запросах
+  /// RunQueries приводятся к единому виду прямо при разборе: «Война и МИР»,
+  /// «война  и мир» и «Война и мир» с неразрывным пробелом — одна книга.
+  /// В каталоге и результатах остается нормализованное написание. Уже
+  /// прочитанные названия не меняются, поэтому включать нормализацию нужно
+  /// до ReadData.</remarks>
+  void SetTitleNormalization(bool enabled);
+
+  /// <summary>Возвращает, включена ли нормализация названий.</summary>
+  /// <returns>true, если названия нормализуются.</returns>
+  bool TitleNormalization() const;
+
+private:
+  AnalysisMode mode_ = AnalysisMode::kSets;
+  ReaderStorage storage_ = ReaderStorage::kHashSets;
+  bool normalize_titles_ = false;
+  /// <summary>Пул потоков; создается, только если потоков больше
+  /// одного.</summary>
+  std::unique_ptr<ThreadPool> pool_;
+  StringPool titles_;
+  BookSet all_books_;
+  /// <summary>Арена для множеств readers_books_; объявлена раньше них, чтобы
+  /// пережить их.</summary>
+  MonotonicArena readers_arena_;
+  std::vector<BookSet> readers_books_;
+  /// <summary>Множества читателей при ReaderStorage::kCompressed; тогда
+  /// readers_books_ пуст.</summary>
+  std::vector<RoaringBitmap> compressed_readers_;
+  BookSet books_read_by_all_;
+  BookSet books_read_by_some_;
+  BookSet books_read_by_none_;
+  BookSet books_read_by_someone_;
+  /// <summary>Счетчики для режима kIncremental.</summary>
+  TitleCountIndex counts_;
+  /// <summary>true, если counts_ построен и поддерживается.</summary>
+  bool incremental_ready_ = false;
+  /// <summary>Обратный индекс для RunQueries.</summary>
+  ReaderIndex reader_index_;
+  /// <summary>true, если reader_index_ построен и поддерживается.</summary>
+  bool index_ready_ = false;
+  /// <summary>true, если категории соответствуют текущим данным.</summary>
+  bool results_ready_ = false;
+  /// <summary>Загруженный снимок; пока он есть, titles_, all_books_,
+  /// readers_books_ и категории пусты, а данные читаются из него.</summary>
+  std::unique_ptr<BookSnapshot> snapshot_;
+
+  /// <summary>Переносит данные снимка в контейнеры и закрывает его (ничего
+  /// не делает без снимка).</summary>
+  void MaterializeSnapshot();
+
+  /// <summary>Сжимает readers_books_ в конец compressed_readers_ и
+  /// освобождает арену.</summary>
+  void CompressReaders();
+
+  /// <summary>Разворачивает compressed_readers_ в readers_books_.</summary>
+  void ExpandReaders();
+
+  /// <summary>Удаляет все данные и результаты.</summary>
+  void ResetData();
+
+  /// <summary>Возвращает название книги по номеру.</summary>
+  std::string_view TitleOf(StringId id) const;
+
+  /// <summary>Возвращает количество книг в каталоге.</summary>
+  std::size_t CatalogSize() const;
+
+  /// <summary>Возвращает количество читателей.</summary>
+  std::size_t ReaderCount() const;
+
+  /// <summary>Возвращает книги читателя.</summary>
+  /// <param name="reader">Номер читателя.</param>
+  /// <param name="buffer">Буфер, в который разворачивается сжатое
+  /// множество.</param>
+  /// <returns>Отрезок множества читателя или buffer.</returns>
+  TitleSpan ReaderBooks(std::size_t reader,
+                        std::vector<StringId> &buffer) const;
+
+  /// <summary>Возвращает количество книг читателя.</summary>
+  std::size_t ReaderSize(std::size_t reader) const;
+
+  /// <summary>Строит reader_index_ по всем читателям.</summary>
+  void BuildReaderIndex();
+
+  /// <summary>Отвечает на один запрос по reader_index_.</summary>
+  void AnswerQuery(const BookQuery &query, BookQueryResult &result) const;
+
+  /// <summary>Разбирает раздел читателей в текущем потоке.</summary>
+  /// <param name="text">Часть файла после пустой строки.</param>
+  void ReadReaders(std::string_view text);
+
+  /// <summary>Разбирает раздел читателей параллельно.</summary>
+  /// <param name="text">Часть файла после пустой строки.</param>
+  /// <remarks>Текст делится на куски по границам строк; каждый кусок
+  /// разбирается в свой локальный пул новых названий и список читателей,
+  /// затем куски сливаются по порядку, поэтому номера названий и порядок
+  /// читателей совпадают с ReadReaders. Множества читателей создаются в
+  /// арене последовательно, а заполняются параллельно.</remarks>
+  void ReadReadersParallel(std::string_view text);
+
+  /// <summary>Анализ цепочками операций над UnorderedSet.</summary>
+  void AnalyzeSets();
+
+  /// <summary>Анализ над отсортированными множествами (см.
+  /// AnalysisMode::kSorted).</summary>
+  void AnalyzeSorted();
+
+  /// <summary>Анализ над битовыми множествами (см. AnalysisMode::kBitset).</summary>
+  void AnalyzeBitset();
+
+  /// <summary>Анализ над сжатыми множествами (см.
+  /// ReaderStorage::kCompressed).</summary>
+  void AnalyzeCompressed();
+
+  /// <summary>Строит счетчики читателей (см. AnalysisMode::kIncremental).</summary>
+  void AnalyzeIncremental();
+
+  /// <summary>Возвращает книги категорий «все», «некоторые», «никто».</summary>
+  /// <param name="category">0 — все, 1 — некоторые, 2 — никто.</param>
+  /// <returns>Номера книг категории (без копирования).</returns>
+  TitleSpan CategoryBooks(int category) const;
+
+  /// <summary>Форматирует результаты анализа.</summary>
+  /// <param name="out">Получатели текста.</param>
+  void WriteResults(OutputSink &out) const;
+
+  /// <summary>Форматирует множество книг с заголовком.</summary>
+  /// <param name="out">Получатели текста.</param>
+  /// <param name="title">Заголовок.</param>
+  /// <param name="books">Книги.</param>
+  void WriteSet(OutputSink &out, std::string_view title,
+                TitleSpan books) const;
+};
+
+#endif // BOOK_ANALYZER_H_
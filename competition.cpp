@@ -0,0 +1,285 @@
+#include "competition.h"
+
+#include "mapped_file.h"
+#include "metrics.h"
+#include "output_sink.h"
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// Пробельные символы в смысле std::isspace для локали "C".
+inline bool IsBlank(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+} // namespace
+
+ScoreScanner::ScoreScanner(std::string_view text)
+    : pos_(text.data()), end_(text.data() + text.size()) {}
+
+bool ScoreScanner::NextWord(std::string_view &word) {
+  SkipBlanks();
+  if (pos_ == end_)
+    return false;
+  const char *start = pos_;
+  while (pos_ != end_ && !IsBlank(*pos_))
+    ++pos_;
+  word = std::string_view(start, static_cast<std::size_t>(pos_ - start));
+  return true;
+}
+
+bool ScoreScanner::NextInt(long long &value) {
+  SkipBlanks();
+  if (pos_ == end_)
+    return false;
+  const char *start = pos_;
+  // std::from_chars не принимает ведущий '+', в отличие от operator>>.
+  if (*start == '+' && start + 1 != end_ && start[1] != '-')
+    ++start;
+  auto result = std::from_chars(start, end_, value);
+  if (result.ec != std::errc() || (result.ptr != end_ && !IsBlank(*result.ptr)))
+    return false;
+  pos_ = result.ptr;
+  return true;
+}
+
+std::size_t ScoreScanner::Remaining() const {
+  return static_cast<std::size_t>(end_ - pos_);
+}
+
+void ScoreScanner::SkipBlanks() {
+  while (pos_ != end_ && IsBlank(*pos_))
+    ++pos_;
+}
+
+namespace {
+
+/// Сумма строки баллов: AVX2 складывает по 8 значений за итерацию в двух
+/// независимых 4-элементных накопителях, хвост — скалярно.
+long long SumRow(const long long *row, std::size_t count) {
+  std::size_t j = 0;
+  long long sum = 0;
+#if defined(__AVX2__)
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  for (; j + 8 <= count; j += 8) {
+    acc0 = _mm256_add_epi64(
+        acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + j)));
+    acc1 = _mm256_add_epi64(
+        acc1,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + j + 4)));
+  }
+  alignas(32) long long lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes),
+                     _mm256_add_epi64(acc0, acc1));
+  sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+  for (; j < count; ++j)
+    sum += row[j];
+  return sum;
+}
+
+} // namespace
+
+Competition::Competition()
+    : event_count_(0), surnames_(), names_(), scores_(), totals_() {}
+
+bool Competition::ReadFile(const std::string &filename,
+                           const CompetitionOptions &options) {
+  METRICS_PHASE(kCompetitionRead);
+  MappedFile in;
+  if (!in.Open(filename)) {
+    std::cerr << "Не удалось открыть файл " << filename << std::endl;
+    return false;
+  }
+
+  // Числа разбираются std::from_chars прямо в отображенной памяти, без
+  // потоков, локалей и промежуточных строк.
+  ScoreScanner scanner(in.Data());
+  auto read_int = [&scanner](int &value) {
+    long long parsed = 0;
+    if (!scanner.NextInt(parsed) || parsed < std::numeric_limits<int>::min() ||
+        parsed > std::numeric_limits<int>::max())
+      return false;
+    value = static_cast<int>(parsed);
+    return true;
+  };
+
+  int N = 0, M = 0;
+  if (!read_int(N)) {
+    std::cerr << "Ошибка чтения N из " << filename << std::endl;
+    return false;
+  }
+  if (!read_int(M)) {
+    std::cerr << "Ошибка чтения M из " << filename << std::endl;
+    return false;
+  }
+  if (N < 0 || static_cast<std::size_t>(N) >= options.max_athletes) {
+    std::cerr << "N вне допустимого диапазона (0.."
+              << (options.max_athletes == 0 ? 0 : options.max_athletes - 1)
+              << ")\n";
+    return false;
+  }
+  if (M < 0) {
+    std::cerr << "M некорректно\n";
+    return false;
+  }
+  METRICS_ADD(kTokens, 2);
+
+  event_count_ = static_cast<std::size_t>(M);
+  surnames_.clear();
+  names_.clear();
+  scores_.clear();
+  surnames_.reserve(static_cast<std::size_t>(N));
+  names_.reserve(static_cast<std::size_t>(N));
+  // Каждый балл занимает в файле не меньше 2 байт (разделитель и цифра):
+  // память под баллы не может превысить то, что файл способен вместить,
+  // даже если M в заголовке неправдоподобно велико.
+  std::size_t max_scores = in.Data().size() / 2;
+  std::size_t total_scores = static_cast<std::size_t>(N) * event_count_;
+  scores_.reserve(total_scores < max_scores ? total_scores : max_scores);
+
+  for (int i = 0; i < N; ++i) {
+    std::string_view surname, name;
+    if (!scanner.NextWord(surname) || !scanner.NextWord(name)) {
+      std::cerr << "Ошибка чтения Фамилии/Имени спортсмена на строке "
+                << (i + 1) << std::endl;
+      return false;
+    }
+    if (event_count_ > scanner.Remaining() / 2) {
+      std::cerr << "Ошибка чтения баллов у " << surname << " " << name
+                << std::endl;
+      return false;
+    }
+    scores_.resize(scores_.size() + event_count_);
+    long long *row =
+        scores_.data() + static_cast<std::size_t>(i) * event_count_;
+    for (int j = 0; j < M; ++j) {
+      if (!scanner.NextInt(row[j])) {
+        std::cerr << "Ошибка чтения баллов у " << surname << " " << name
+                  << std::endl;
+        return false;
+      }
+    }
+    surnames_.emplace_back(surname);
+    names_.emplace_back(name);
+    METRICS_ADD(kLinesParsed, 1);
+    METRICS_ADD(kTokens, 2 + M);
+  }
+
+  ComputeTotals();
+  return true;
+}
+
+std::size_t Competition::AthleteCount() const { return surnames_.size(); }
+
+std::size_t Competition::EventCount() const { return event_count_; }
+
+const std::string &Competition::Surname(std::size_t athlete) const {
+  return surnames_[athlete];
+}
+
+const std::string &Competition::Name(std::size_t athlete) const {
+  return names_[athlete];
+}
+
+long long Competition::Score(std::size_t athlete, std::size_t event) const {
+  return scores_[athlete * event_count_ + event];
+}
+
+const long long *Competition::Scores(std::size_t athlete) const {
+  return scores_.data() + athlete * event_count_;
+}
+
+std::vector<long long> Competition::EventScores(std::size_t event) const {
+  std::vector<long long> result(AthleteCount());
+  for (std::size_t i = 0; i < result.size(); ++i)
+    result[i] = scores_[i * event_count_ + event];
+  return result;
+}
+
+long long Competition::Total(std::size_t athlete) const {
+  return totals_[athlete];
+}
+
+Athlete Competition::GetAthlete(std::size_t athlete) const {
+  return {surnames_[athlete], names_[athlete], totals_[athlete], athlete};
+}
+
+void Competition::ComputeTotals() {
+  totals_.resize(AthleteCount());
+  for (std::size_t i = 0; i < totals_.size(); ++i)
+    totals_[i] = SumRow(Scores(i), event_count_);
+}
+
+bool RunCompetition(const std::string &infile, const std::string &outfile,
+                    const CompetitionOptions &options) {
+  Competition competition;
+  if (!competition.ReadFile(infile, options))
+    return false;
+
+  std::size_t N = competition.AthleteCount();
+  std::size_t M = competition.EventCount();
+
+  std::vector<std::size_t> order(N);
+  std::vector<int> rank(N);
+  {
+    METRICS_PHASE(kCompetitionRank);
+    // Сортировка номеров по убыванию суммы, стабильная (сохранение порядка
+    // при равных суммах).
+    for (std::size_t i = 0; i < N; ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&competition](std::size_t a, std::size_t b) {
+                       return competition.Total(a) > competition.Total(b);
+                     });
+
+    // Присвоение плотных мест: 1,1,2,...
+    long long prev_sum = std::numeric_limits<long long>::min();
+    int dense_rank = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+      if (competition.Total(order[i]) != prev_sum) {
+        ++dense_rank;
+        prev_sum = competition.Total(order[i]);
+      }
+      rank[i] = dense_rank;
+    }
+  }
+
+  METRICS_PHASE(kCompetitionOutput);
+  // Строки форматируются один раз и уходят сразу в консоль и в outfile.
+  std::cout << "\nРезультаты многоборья (из " << N << " спортсменов, " << M
+            << " видов):\n";
+  OutputSink out;
+  out.AddStdout();
+  bool saved = out.AddFile(outfile);
+  for (std::size_t i = 0; i < N; ++i) {
+    out.Write(competition.Surname(order[i]))
+        .Write(' ')
+        .Write(competition.Name(order[i]))
+        .Write(' ')
+        .Write(competition.Total(order[i]))
+        .Write(' ')
+        .Write(rank[i])
+        .Write('\n');
+  }
+  out.Flush();
+
+  if (saved) {
+    std::cout << "\nРезультаты многоборья сохранены в файл: " << outfile
+              << std::endl;
+  } else {
+    std::cerr << "Не удалось создать файл " << outfile
+              << " для записи результатов\n";
+  }
+
+  return true;
+}
@@ -0,0 +1,136 @@
+#ifndef COMPETITION_H_
+#define COMPETITION_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>Структура для хранения информации о спортсмене.</summary>
+/// <remarks>Используется в задаче многоборья.</remarks>
+struct Athlete {
+  std::string surname;
+  std::string name;
+  long long sum;
+  std::size_t input_index;
+};
+
+/// <summary>Параметры задачи многоборья.</summary>
+struct CompetitionOptions {
+  /// <summary>Допустимое количество спортсменов: N должно быть меньше этого
+  /// значения (по условию задачи — 1000).</summary>
+  std::size_t max_athletes = 1000;
+};
+
+/// <summary>Последовательный разбор слов и целых чисел из буфера.</summary>
+/// <remarks>Работает прямо по памяти входного файла: слова возвращаются как
+/// std::string_view, числа разбираются std::from_chars без потоков и локалей.
+/// Пробельными считаются те же символы, что и у std::isspace в локали
+/// "C".</remarks>
+class ScoreScanner {
+public:
+  /// <summary>Создает сканер над буфером.</summary>
+  /// <param name="text">Буфер; должен жить дольше сканера.</param>
+  explicit ScoreScanner(std::string_view text);
+
+  /// <summary>Читает очередное слово.</summary>
+  /// <param name="word">Слово (представление внутри буфера).</param>
+  /// <returns>false, если слов больше нет.</returns>
+  bool NextWord(std::string_view &word);
+
+  /// <summary>Читает очередное целое число.</summary>
+  /// <param name="value">Результат.</param>
+  /// <returns>false, если очередное слово не является числом, помещающимся в
+  /// long long, или слов больше нет.</returns>
+  bool NextInt(long long &value);
+
+  /// <summary>Возвращает число непрочитанных байтов буфера.</summary>
+  std::size_t Remaining() const;
+
+private:
+  const char *pos_;
+  const char *end_;
+
+  void SkipBlanks();
+};
+
+/// <summary>Результаты многоборья в столбцовом представлении.</summary>
+/// <remarks>Баллы всех спортсменов лежат в одном непрерывном массиве: строка
+/// из EventCount() значений на спортсмена, в порядке ввода. Суммы
+/// вычисляются векторизованным ядром (AVX2 при сборке с -mavx2, иначе
+/// скалярный цикл) и хранятся отдельно, так что баллы по видам остаются
+/// доступны для последующих запросов.</remarks>
+class Competition {
+public:
+  /// <summary>Конструктор по умолчанию. Нет ни спортсменов, ни
+  /// видов.</summary>
+  Competition();
+
+  /// <summary>Читает N, M и N строк «Фамилия Имя M баллов» из файла и
+  /// вычисляет суммы.</summary>
+  /// <param name="filename">Имя входного файла.</param>
+  /// <param name="options">Параметры задачи (ограничение на N).</param>
+  /// <returns>true, если данные прочитаны; иначе сообщение об ошибке
+  /// выводится в std::cerr.</returns>
+  bool ReadFile(const std::string &filename,
+                const CompetitionOptions &options = CompetitionOptions());
+
+  /// <summary>Возвращает количество спортсменов.</summary>
+  std::size_t AthleteCount() const;
+
+  /// <summary>Возвращает количество видов.</summary>
+  std::size_t EventCount() const;
+
+  /// <summary>Возвращает фамилию спортсмена.</summary>
+  /// <param name="athlete">Номер спортсмена в порядке ввода.</param>
+  const std::string &Surname(std::size_t athlete) const;
+
+  /// <summary>Возвращает имя спортсмена.</summary>
+  /// <param name="athlete">Номер спортсмена в порядке ввода.</param>
+  const std::string &Name(std::size_t athlete) const;
+
+  /// <summary>Возвращает балл спортсмена в одном виде.</summary>
+  /// <param name="athlete">Номер спортсмена.</param>
+  /// <param name="event">Номер вида.</param>
+  long long Score(std::size_t athlete, std::size_t event) const;
+
+  /// <summary>Возвращает строку баллов спортсмена (EventCount()
+  /// значений).</summary>
+  /// <param name="athlete">Номер спортсмена.</param>
+  const long long *Scores(std::size_t athlete) const;
+
+  /// <summary>Возвращает баллы всех спортсменов в одном виде.</summary>
+  /// <param name="event">Номер вида.</param>
+  /// <returns>Вектор из AthleteCount() значений.</returns>
+  std::vector<long long> EventScores(std::size_t event) const;
+
+  /// <summary>Возвращает сумму баллов спортсмена.</summary>
+  /// <param name="athlete">Номер спортсмена.</param>
+  long long Total(std::size_t athlete) const;
+
+  /// <summary>Возвращает данные спортсмена в виде Athlete.</summary>
+  /// <param name="athlete">Номер спортсмена.</param>
+  Athlete GetAthlete(std::size_t athlete) const;
+
+  /// <summary>Пересчитывает суммы всех спортсменов.</summary>
+  void ComputeTotals();
+
+private:
+  std::size_t event_count_;
+  std::vector<std::string> surnames_;
+  std::vector<std::string> names_;
+  /// <summary>Баллы: AthleteCount() строк по EventCount() значений.</summary>
+  std::vector<long long> scores_;
+  std::vector<long long> totals_;
+};
+
+/// <summary>Читает входные данные многоборья из файла, сортирует спортсменов и
+/// сохраняет результаты.</summary> <param name="infile">Имя входного файла
+/// (например, input2.txt).</param> <param name="outfile">Имя выходного файла
+/// (например, output2.txt).</param> <param name="options">Параметры задачи
+/// (ограничение на N).</param> <returns>true, если успешно, иначе
+/// false.</returns>
+bool RunCompetition(const std::string &infile, const std::string &outfile,
+                    const CompetitionOptions &options = CompetitionOptions());
+
+#endif // COMPETITION_H_
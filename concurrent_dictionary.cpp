@@ -0,0 +1,110 @@
+#include "concurrent_dictionary.h"
+
+#include <string>
+
+template <typename K, typename V, typename H, typename E>
+ConcurrentDictionary<K, V, H, E>::ConcurrentDictionary(std::size_t shard_count)
+    : shards_(), shard_mask_(ConcurrentShardCount(shard_count) - 1),
+      shard_shift_(ConcurrentShardShift(shard_mask_ + 1)), hash_() {
+  shards_.reset(new Shard[shard_mask_ + 1]);
+}
+
+template <typename K, typename V, typename H, typename E>
+typename ConcurrentDictionary<K, V, H, E>::Shard &
+ConcurrentDictionary<K, V, H, E>::ShardOf(const K &key) const {
+  return shards_[ConcurrentShardIndex(hash_(key), shard_shift_)];
+}
+
+template <typename K, typename V, typename H, typename E>
+bool ConcurrentDictionary<K, V, H, E>::Add(const K &key, const V &value) {
+  Shard &shard = ShardOf(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  std::size_t before = shard.dictionary.Size();
+  shard.dictionary.Add(key, value);
+  return shard.dictionary.Size() != before;
+}
+
+template <typename K, typename V, typename H, typename E>
+bool ConcurrentDictionary<K, V, H, E>::Get(const K &key, V &value) const {
+  const Shard &shard = ShardOf(key);
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  const V *found = shard.dictionary.Get(key);
+  if (found == nullptr)
+    return false;
+  value = *found;
+  return true;
+}
+
+template <typename K, typename V, typename H, typename E>
+bool ConcurrentDictionary<K, V, H, E>::Contains(const K &key) const {
+  const Shard &shard = ShardOf(key);
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.dictionary.Contains(key);
+}
+
+template <typename K, typename V, typename H, typename E>
+bool ConcurrentDictionary<K, V, H, E>::Remove(const K &key) {
+  Shard &shard = ShardOf(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.dictionary.Remove(key);
+}
+
+template <typename K, typename V, typename H, typename E>
+std::size_t ConcurrentDictionary<K, V, H, E>::Size() const {
+  std::size_t size = 0;
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    size += shards_[i].dictionary.Size();
+  }
+  return size;
+}
+
+template <typename K, typename V, typename H, typename E>
+bool ConcurrentDictionary<K, V, H, E>::IsEmpty() const {
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    if (!shards_[i].dictionary.IsEmpty())
+      return false;
+  }
+  return true;
+}
+
+template <typename K, typename V, typename H, typename E>
+void ConcurrentDictionary<K, V, H, E>::Reserve(std::size_t count) {
+  if (count == 0)
+    return;
+  // Как в ConcurrentUnorderedSet: поровну с запасом 1/8 на разброс.
+  std::size_t per_shard = count / (shard_mask_ + 1);
+  per_shard += per_shard / 8 + 1;
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].dictionary.Reserve(per_shard);
+  }
+}
+
+template <typename K, typename V, typename H, typename E>
+void ConcurrentDictionary<K, V, H, E>::Clear() {
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].dictionary.Clear();
+  }
+}
+
+template <typename K, typename V, typename H, typename E>
+std::size_t ConcurrentDictionary<K, V, H, E>::ShardCount() const {
+  return shard_mask_ + 1;
+}
+
+template <typename K, typename V, typename H, typename E>
+std::vector<std::pair<K, V>> ConcurrentDictionary<K, V, H, E>::ToVector() const {
+  std::vector<std::pair<K, V>> result;
+  ForEach([&result](const K &key, const V &value) {
+    result.emplace_back(key, value);
+  });
+  return result;
+}
+
+// --- явные инстанциации ---
+template class ConcurrentDictionary<std::string, long long>;
+template class ConcurrentDictionary<std::string, int>;
+template class ConcurrentDictionary<std::string, std::size_t>;
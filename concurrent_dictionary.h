@@ -0,0 +1,161 @@
+#ifndef CONCURRENT_DICTIONARY_H_
+#define CONCURRENT_DICTIONARY_H_
+
+#include "concurrent_unordered_set.h"
+#include "dictionary.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+/// <summary>Потокобезопасный словарь из независимо блокируемых
+/// сегментов.</summary>
+/// <typeparam name="K">Тип ключа.</typeparam>
+/// <typeparam name="V">Тип значения.</typeparam>
+/// <typeparam name="Hash">Хеш-функция для ключей.</typeparam>
+/// <typeparam name="KeyEqual">Предикат равенства ключей.</typeparam>
+/// <remarks>Устроен как ConcurrentUnorderedSet: ключи распределены по
+/// сегментам, каждый сегмент — Dictionary под своим std::shared_mutex.
+/// Изменения блокируют один сегмент монопольно, чтения — разделяемо.
+///
+/// Указатели на значения наружу не выдаются: Get копирует значение, а
+/// чтение-изменение-запись (например, счетчик) выполняется целиком под
+/// блокировкой сегмента через AddOrUpdate. Size, ForEach и ToVector обходят
+/// сегменты по очереди и не являются мгновенным снимком при одновременных
+/// изменениях.</remarks>
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>>
+class ConcurrentDictionary {
+public:
+  using value_type = std::pair<K, V>;
+  using size_type = std::size_t;
+
+  /// <summary>Создает пустой словарь.</summary>
+  /// <param name="shard_count">Число сегментов, округляется вверх до степени
+  /// двойки; 0 — в 4 раза больше числа аппаратных потоков.</param>
+  explicit ConcurrentDictionary(std::size_t shard_count = 0);
+
+  ConcurrentDictionary(const ConcurrentDictionary &) = delete;
+  ConcurrentDictionary &operator=(const ConcurrentDictionary &) = delete;
+
+  /// <summary>Добавляет пару; если ключ уже есть — заменяет
+  /// значение.</summary>
+  /// <param name="key">Ключ.</param>
+  /// <param name="value">Значение.</param>
+  /// <returns>true, если ключа не было.</returns>
+  bool Add(const K &key, const V &value);
+
+  /// <summary>Добавляет пару, конструируя значение из args, только если
+  /// ключа еще нет.</summary>
+  /// <returns>true, если пара добавлена.</returns>
+  template <typename... Args> bool Emplace(const K &key, Args &&...args);
+
+  /// <summary>Добавляет пару (key, add_value) или, если ключ уже есть,
+  /// вызывает update(значение) — атомарно относительно других операций с
+  /// этим ключом.</summary>
+  /// <param name="key">Ключ.</param>
+  /// <param name="add_value">Значение для нового ключа.</param>
+  /// <param name="update">Функция, принимающая V&amp; и изменяющая его на
+  /// месте; вызывается под блокировкой сегмента и не должна обращаться к
+  /// этому словарю.</param>
+  /// <returns>true, если ключ добавлен.</returns>
+  template <typename Update>
+  bool AddOrUpdate(const K &key, const V &add_value, Update update);
+
+  /// <summary>Копирует значение по ключу.</summary>
+  /// <param name="key">Ключ.</param>
+  /// <param name="value">Получает значение, если ключ найден.</param>
+  /// <returns>true, если ключ найден.</returns>
+  bool Get(const K &key, V &value) const;
+
+  /// <summary>Проверяет наличие ключа.</summary>
+  /// <param name="key">Ключ.</param>
+  /// <returns>true, если ключ есть.</returns>
+  bool Contains(const K &key) const;
+
+  /// <summary>Удаляет пару по ключу.</summary>
+  /// <param name="key">Ключ.</param>
+  /// <returns>true, если пара была удалена.</returns>
+  bool Remove(const K &key);
+
+  /// <summary>Возвращает количество пар (см. remarks класса).</summary>
+  std::size_t Size() const;
+
+  /// <summary>Проверяет, пуст ли словарь.</summary>
+  bool IsEmpty() const;
+
+  /// <summary>Заранее выделяет место под count пар, поровну по
+  /// сегментам.</summary>
+  /// <param name="count">Ожидаемое количество пар.</param>
+  void Reserve(std::size_t count);
+
+  /// <summary>Удаляет все пары.</summary>
+  void Clear();
+
+  /// <summary>Возвращает число сегментов.</summary>
+  std::size_t ShardCount() const;
+
+  /// <summary>Вызывает visitor(ключ, значение) для каждой пары, сегмент за
+  /// сегментом.</summary>
+  /// <param name="visitor">Функция, вызываемая под разделяемой блокировкой
+  /// сегмента; не должна изменять этот словарь.</param>
+  template <typename Visitor> void ForEach(Visitor visitor) const;
+
+  /// <summary>Копирует все пары в вектор.</summary>
+  /// <returns>Пары в порядке сегментов.</returns>
+  std::vector<std::pair<K, V>> ToVector() const;
+
+private:
+  /// <summary>Сегмент: словарь и его блокировка на отдельной строке
+  /// кеша.</summary>
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    Dictionary<K, V, Hash, KeyEqual> dictionary;
+  };
+
+  std::unique_ptr<Shard[]> shards_;
+  std::size_t shard_mask_;
+  std::size_t shard_shift_;
+  Hash hash_;
+
+  /// <summary>Возвращает сегмент ключа.</summary>
+  Shard &ShardOf(const K &key) const;
+};
+
+template <typename K, typename V, typename H, typename E>
+template <typename... Args>
+bool ConcurrentDictionary<K, V, H, E>::Emplace(const K &key, Args &&...args) {
+  Shard &shard = ShardOf(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.dictionary.Emplace(key, std::forward<Args>(args)...);
+}
+
+template <typename K, typename V, typename H, typename E>
+template <typename Update>
+bool ConcurrentDictionary<K, V, H, E>::AddOrUpdate(const K &key,
+                                                   const V &add_value,
+                                                   Update update) {
+  Shard &shard = ShardOf(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  if (V *value = shard.dictionary.Get(key)) {
+    update(*value);
+    return false;
+  }
+  shard.dictionary.Add(key, add_value);
+  return true;
+}
+
+template <typename K, typename V, typename H, typename E>
+template <typename Visitor>
+void ConcurrentDictionary<K, V, H, E>::ForEach(Visitor visitor) const {
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].dictionary.ForEach(visitor);
+  }
+}
+
+#endif // CONCURRENT_DICTIONARY_H_
@@ -0,0 +1,131 @@
+#include "concurrent_unordered_set.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+
+std::size_t ConcurrentShardCount(std::size_t requested) {
+  if (requested == 0) {
+    // Несколько сегментов на поток: вероятность, что два потока
+    // одновременно попадут в один сегмент, падает, а памяти на пустые
+    // сегменты уходит немного.
+    std::size_t threads = std::thread::hardware_concurrency();
+    requested = 4 * (threads == 0 ? 1 : threads);
+  }
+  std::size_t count = 1;
+  while (count < requested)
+    count <<= 1;
+  return count;
+}
+
+std::size_t ConcurrentShardShift(std::size_t shard_count) {
+  std::size_t shift = 64;
+  for (; shard_count > 1; shard_count >>= 1)
+    --shift;
+  return shift;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+ConcurrentUnorderedSet<T, Hash, KeyEqual>::ConcurrentUnorderedSet(
+    std::size_t shard_count)
+    : shards_(), shard_mask_(ConcurrentShardCount(shard_count) - 1),
+      shard_shift_(ConcurrentShardShift(shard_mask_ + 1)), hash_() {
+  shards_.reset(new Shard[shard_mask_ + 1]);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+typename ConcurrentUnorderedSet<T, Hash, KeyEqual>::Shard &
+ConcurrentUnorderedSet<T, Hash, KeyEqual>::ShardOf(const T &value) const {
+  return shards_[ConcurrentShardIndex(hash_(value), shard_shift_)];
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentUnorderedSet<T, Hash, KeyEqual>::Add(const T &value) {
+  Shard &shard = ShardOf(value);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  std::size_t before = shard.set.Size();
+  shard.set.Add(value);
+  return shard.set.Size() != before;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentUnorderedSet<T, Hash, KeyEqual>::Add(T &&value) {
+  Shard &shard = ShardOf(value);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  std::size_t before = shard.set.Size();
+  shard.set.Add(std::move(value));
+  return shard.set.Size() != before;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentUnorderedSet<T, Hash, KeyEqual>::Contains(const T &value) const {
+  const Shard &shard = ShardOf(value);
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.set.Contains(value);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentUnorderedSet<T, Hash, KeyEqual>::Remove(const T &value) {
+  Shard &shard = ShardOf(value);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.set.Remove(value);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+std::size_t ConcurrentUnorderedSet<T, Hash, KeyEqual>::Size() const {
+  std::size_t size = 0;
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    size += shards_[i].set.Size();
+  }
+  return size;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentUnorderedSet<T, Hash, KeyEqual>::IsEmpty() const {
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    if (!shards_[i].set.IsEmpty())
+      return false;
+  }
+  return true;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void ConcurrentUnorderedSet<T, Hash, KeyEqual>::Reserve(std::size_t count) {
+  if (count == 0)
+    return;
+  // Хеши распределяют элементы почти поровну; запас на разброс — 1/8.
+  std::size_t per_shard = count / (shard_mask_ + 1);
+  per_shard += per_shard / 8 + 1;
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].set.Reserve(per_shard);
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void ConcurrentUnorderedSet<T, Hash, KeyEqual>::Clear() {
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].set.Clear();
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+std::size_t ConcurrentUnorderedSet<T, Hash, KeyEqual>::ShardCount() const {
+  return shard_mask_ + 1;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+std::vector<T> ConcurrentUnorderedSet<T, Hash, KeyEqual>::ToVector() const {
+  std::vector<T> result;
+  ForEach([&result](const T &value) { result.push_back(value); });
+  return result;
+}
+
+// --- явные инстанциации ---
+template class ConcurrentUnorderedSet<int>;
+template class ConcurrentUnorderedSet<std::uint32_t>;
+template class ConcurrentUnorderedSet<std::string>;
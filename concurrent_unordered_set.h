@@ -0,0 +1,151 @@
+#ifndef CONCURRENT_UNORDERED_SET_H_
+#define CONCURRENT_UNORDERED_SET_H_
+
+#include "unordered_set.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+/// <summary>Число сегментов по умолчанию для concurrent-контейнеров.</summary>
+/// <param name="requested">Запрошенное число; 0 — по числу аппаратных
+/// потоков.</param>
+/// <returns>Степень двойки не меньше requested.</returns>
+std::size_t ConcurrentShardCount(std::size_t requested);
+
+/// <summary>Сдвиг для ConcurrentShardIndex.</summary>
+/// <param name="shard_count">Число сегментов (степень двойки).</param>
+/// <returns>64 - log2(shard_count).</returns>
+std::size_t ConcurrentShardShift(std::size_t shard_count);
+
+/// <summary>Номер сегмента по хешу: самые старшие биты произведения на
+/// нечетную константу.</summary>
+/// <param name="hash">Хеш ключа.</param>
+/// <param name="shard_shift">Результат ConcurrentShardShift.</param>
+/// <remarks>Таблицы сегментов тоже умножают хеш на 0x9E3779B97F4A7C15:
+/// Dictionary::HashOf берет ячейку из битов 32 и выше, UnorderedSet::HashOf —
+/// из младших (с примесью битов от 29-го). Биты от 64 - log2(числа
+/// сегментов) ни одна таблица реальной емкости не использует, поэтому ключи
+/// одного сегмента по-прежнему равномерно распределены по его
+/// ячейкам.</remarks>
+inline std::size_t ConcurrentShardIndex(std::size_t hash,
+                                        std::size_t shard_shift) {
+  std::uint64_t mixed =
+      static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+  // Сдвиг на 64 (один сегмент) не определен в C++.
+  return shard_shift >= 64 ? 0 : static_cast<std::size_t>(mixed >> shard_shift);
+}
+
+/// <summary>Потокобезопасное множество из независимо блокируемых
+/// сегментов.</summary>
+/// <typeparam name="T">Тип элементов.</typeparam>
+/// <typeparam name="Hash">Хеш-функция для элементов.</typeparam>
+/// <typeparam name="KeyEqual">Предикат равенства элементов.</typeparam>
+/// <remarks>Элементы распределены по ShardCount() сегментам (степень двойки)
+/// по старшим битам перемешанного хеша; каждый сегмент — обычный
+/// UnorderedSet под своим std::shared_mutex. Add и Remove блокируют один
+/// сегмент монопольно, Contains — разделяемо, поэтому потоки, работающие с
+/// разными сегментами, не мешают друг другу, а чтения одного сегмента идут
+/// параллельно. Сегменты выровнены по строке кеша, чтобы блокировки соседей
+/// не делили строку.
+///
+/// Size, ForEach и ToVector обходят сегменты по очереди, блокируя по одному:
+/// при одновременных изменениях результат не является мгновенным снимком,
+/// но каждый элемент, который не менялся во время обхода, учитывается ровно
+/// один раз. Итераторов и указателей на элементы нет — они стали бы
+/// недействительными при изменении сегмента другим потоком.</remarks>
+template <typename T, typename Hash = std::hash<T>,
+          typename KeyEqual = std::equal_to<T>>
+class ConcurrentUnorderedSet {
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /// <summary>Создает пустое множество.</summary>
+  /// <param name="shard_count">Число сегментов, округляется вверх до степени
+  /// двойки; 0 — в 4 раза больше числа аппаратных потоков.</param>
+  explicit ConcurrentUnorderedSet(std::size_t shard_count = 0);
+
+  ConcurrentUnorderedSet(const ConcurrentUnorderedSet &) = delete;
+  ConcurrentUnorderedSet &operator=(const ConcurrentUnorderedSet &) = delete;
+
+  /// <summary>Добавляет элемент.</summary>
+  /// <param name="value">Элемент.</param>
+  /// <returns>true, если элемента не было; при одновременном добавлении
+  /// равных элементов true получает ровно один поток.</returns>
+  bool Add(const T &value);
+
+  /// <summary>Добавляет элемент перемещением.</summary>
+  /// <param name="value">Элемент.</param>
+  /// <returns>true, если элемента не было.</returns>
+  bool Add(T &&value);
+
+  /// <summary>Проверяет наличие элемента.</summary>
+  /// <param name="value">Элемент.</param>
+  /// <returns>true, если элемент есть в множестве.</returns>
+  bool Contains(const T &value) const;
+
+  /// <summary>Удаляет элемент.</summary>
+  /// <param name="value">Элемент.</param>
+  /// <returns>true, если элемент был удален.</returns>
+  bool Remove(const T &value);
+
+  /// <summary>Возвращает количество элементов (см. remarks класса).</summary>
+  std::size_t Size() const;
+
+  /// <summary>Проверяет, пусто ли множество.</summary>
+  bool IsEmpty() const;
+
+  /// <summary>Заранее выделяет место под count элементов, поровну по
+  /// сегментам.</summary>
+  /// <param name="count">Ожидаемое количество элементов.</param>
+  void Reserve(std::size_t count);
+
+  /// <summary>Удаляет все элементы.</summary>
+  void Clear();
+
+  /// <summary>Возвращает число сегментов.</summary>
+  std::size_t ShardCount() const;
+
+  /// <summary>Вызывает visitor(элемент) для каждого элемента, сегмент за
+  /// сегментом.</summary>
+  /// <param name="visitor">Функция, принимающая const T&amp;; вызывается под
+  /// разделяемой блокировкой сегмента и не должна изменять это
+  /// множество.</param>
+  template <typename Visitor> void ForEach(Visitor visitor) const;
+
+  /// <summary>Копирует элементы в вектор.</summary>
+  /// <returns>Элементы в порядке сегментов.</returns>
+  std::vector<T> ToVector() const;
+
+private:
+  /// <summary>Сегмент: множество и его блокировка на отдельной строке
+  /// кеша.</summary>
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    UnorderedSet<T, Hash, KeyEqual> set;
+  };
+
+  std::unique_ptr<Shard[]> shards_;
+  std::size_t shard_mask_;
+  std::size_t shard_shift_;
+  Hash hash_;
+
+  /// <summary>Возвращает сегмент элемента.</summary>
+  Shard &ShardOf(const T &value) const;
+};
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename Visitor>
+void ConcurrentUnorderedSet<T, Hash, KeyEqual>::ForEach(Visitor visitor) const {
+  for (std::size_t i = 0; i <= shard_mask_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].set.ForEach(visitor);
+  }
+}
+
+#endif // CONCURRENT_UNORDERED_SET_H_
@@ -0,0 +1,148 @@
+#include "dense_bitset.h"
+
+#include "bit_ops.h"
+#include "metrics.h"
+
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kWordBits = 64;
+
+std::size_t WordsFor(std::size_t bit_count) {
+  return (bit_count + kWordBits - 1) / kWordBits;
+}
+
+// Пословные ядра: AVX2 обрабатывает по 4 слова за итерацию, хвост — скалярно.
+
+void AndWords(std::uint64_t *dst, const std::uint64_t *src, std::size_t n) {
+  std::size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_and_si256(a, b));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] &= src[i];
+}
+
+void OrWords(std::uint64_t *dst, const std::uint64_t *src, std::size_t n) {
+  std::size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_or_si256(a, b));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] |= src[i];
+}
+
+void AndNotWords(std::uint64_t *dst, const std::uint64_t *src,
+                 std::size_t n) {
+  std::size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    // _mm256_andnot_si256(b, a) == ~b & a
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_andnot_si256(b, a));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] &= ~src[i];
+}
+
+} // namespace
+
+DenseBitset::DenseBitset() : words_(), bit_count_(0) {}
+
+DenseBitset::DenseBitset(std::size_t bit_count)
+    : words_(WordsFor(bit_count), 0), bit_count_(bit_count) {}
+
+std::size_t DenseBitset::Size() const { return bit_count_; }
+
+void DenseBitset::Set(std::size_t index) {
+  words_[index / kWordBits] |= std::uint64_t{1} << (index % kWordBits);
+}
+
+void DenseBitset::Reset(std::size_t index) {
+  words_[index / kWordBits] &= ~(std::uint64_t{1} << (index % kWordBits));
+}
+
+bool DenseBitset::Test(std::size_t index) const {
+  return (words_[index / kWordBits] >> (index % kWordBits)) & 1;
+}
+
+void DenseBitset::SetAll() {
+  for (auto &word : words_)
+    word = ~std::uint64_t{0};
+  std::size_t tail = bit_count_ % kWordBits;
+  if (tail != 0)
+    words_.back() = (std::uint64_t{1} << tail) - 1;
+}
+
+void DenseBitset::ResetAll() {
+  for (auto &word : words_)
+    word = 0;
+}
+
+std::size_t DenseBitset::Count() const {
+  std::size_t count = 0;
+  for (std::uint64_t word : words_)
+    count += static_cast<std::size_t>(PopCount(word));
+  return count;
+}
+
+bool DenseBitset::None() const {
+  for (std::uint64_t word : words_) {
+    if (word != 0)
+      return false;
+  }
+  return true;
+}
+
+void DenseBitset::AndWith(const DenseBitset &other) {
+  if (other.bit_count_ != bit_count_)
+    throw std::invalid_argument("DenseBitset: размеры множеств не совпадают");
+  METRICS_ADD(kSetOperations, 1);
+  AndWords(words_.data(), other.words_.data(), words_.size());
+}
+
+void DenseBitset::OrWith(const DenseBitset &other) {
+  if (other.bit_count_ != bit_count_)
+    throw std::invalid_argument("DenseBitset: размеры множеств не совпадают");
+  METRICS_ADD(kSetOperations, 1);
+  OrWords(words_.data(), other.words_.data(), words_.size());
+}
+
+void DenseBitset::AndNotWith(const DenseBitset &other) {
+  if (other.bit_count_ != bit_count_)
+    throw std::invalid_argument("DenseBitset: размеры множеств не совпадают");
+  METRICS_ADD(kSetOperations, 1);
+  AndNotWords(words_.data(), other.words_.data(), words_.size());
+}
+
+std::vector<std::size_t> DenseBitset::ToIndices() const {
+  std::vector<std::size_t> result;
+  result.reserve(Count());
+  for (std::size_t w = 0; w < words_.size(); ++w) {
+    std::uint64_t word = words_[w];
+    while (word != 0) {
+      result.push_back(w * kWordBits +
+                       static_cast<std::size_t>(CountTrailingZeros(word)));
+      word &= word - 1;
+    }
+  }
+  return result;
+}
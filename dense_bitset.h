@@ -0,0 +1,77 @@
+#ifndef DENSE_BITSET_H_
+#define DENSE_BITSET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>Битовое множество фиксированного размера над плотными номерами
+/// 0..Size()-1.</summary> <remarks>Биты хранятся 64-битными словами.
+/// Операции AndWith/OrWith/AndNotWith выполняются пословно; при сборке с
+/// поддержкой AVX2 (-mavx2 или -march=native) используются 256-битные ядра,
+/// иначе — скалярный вариант. Биты за пределами Size() всегда равны
+/// нулю.</remarks>
+class DenseBitset {
+public:
+  /// <summary>Конструктор по умолчанию. Создает пустое множество нулевого
+  /// размера.</summary>
+  DenseBitset();
+
+  /// <summary>Создает множество на bit_count битов, все биты
+  /// сброшены.</summary>
+  /// <param name="bit_count">Количество битов.</param>
+  explicit DenseBitset(std::size_t bit_count);
+
+  /// <summary>Возвращает количество битов.</summary>
+  /// <returns>Размер множества в битах.</returns>
+  std::size_t Size() const;
+
+  /// <summary>Устанавливает бит.</summary>
+  /// <param name="index">Номер бита (меньше Size()).</param>
+  void Set(std::size_t index);
+
+  /// <summary>Сбрасывает бит.</summary>
+  /// <param name="index">Номер бита (меньше Size()).</param>
+  void Reset(std::size_t index);
+
+  /// <summary>Проверяет бит.</summary>
+  /// <param name="index">Номер бита (меньше Size()).</param>
+  /// <returns>true, если бит установлен.</returns>
+  bool Test(std::size_t index) const;
+
+  /// <summary>Устанавливает все биты 0..Size()-1.</summary>
+  void SetAll();
+
+  /// <summary>Сбрасывает все биты.</summary>
+  void ResetAll();
+
+  /// <summary>Возвращает количество установленных битов.</summary>
+  /// <returns>Мощность множества.</returns>
+  std::size_t Count() const;
+
+  /// <summary>Проверяет, что ни один бит не установлен.</summary>
+  /// <returns>true, если множество пусто.</returns>
+  bool None() const;
+
+  /// <summary>Пересечение на месте: this &= other.</summary>
+  /// <param name="other">Множество того же размера.</param>
+  void AndWith(const DenseBitset &other);
+
+  /// <summary>Объединение на месте: this |= other.</summary>
+  /// <param name="other">Множество того же размера.</param>
+  void OrWith(const DenseBitset &other);
+
+  /// <summary>Разность на месте: this &= ~other.</summary>
+  /// <param name="other">Множество того же размера.</param>
+  void AndNotWith(const DenseBitset &other);
+
+  /// <summary>Возвращает номера установленных битов по возрастанию.</summary>
+  /// <returns>Вектор номеров.</returns>
+  std::vector<std::size_t> ToIndices() const;
+
+private:
+  std::vector<std::uint64_t> words_;
+  std::size_t bit_count_;
+};
+
+#endif // DENSE_BITSET_H_
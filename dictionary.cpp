@@ -1,28 +1,53 @@
 #include "dictionary.h"
 
+#include "allocators.h"
+#include "metrics.h"
+
+#include <cstring>
 #include <utility>
 #include <new>
 #include <string>
+#include <string_view>
 
-template <typename K, typename V>
-Dictionary<K,V>::Dictionary()
-  : data_(nullptr), size_(0), capacity_(0) {}
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>::Dictionary()
+  : data_(nullptr), size_(0), capacity_(0), slots_(nullptr), slot_count_(0),
+    max_load_factor_(kDefaultMaxLoadFactor), hash_(), equal_(), allocator_() {}
 
-template <typename K, typename V>
-Dictionary<K,V>::~Dictionary() {
-  delete[] data_;
-}
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>::Dictionary(const A& allocator)
+  : data_(nullptr), size_(0), capacity_(0), slots_(nullptr), slot_count_(0),
+    max_load_factor_(kDefaultMaxLoadFactor), hash_(), equal_(), allocator_(allocator) {}
+
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>::Dictionary(const H& hash, const E& equal, const A& allocator)
+  : data_(nullptr), size_(0), capacity_(0), slots_(nullptr), slot_count_(0),
+    max_load_factor_(kDefaultMaxLoadFactor), hash_(hash), equal_(equal), allocator_(allocator) {}
+
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>::~Dictionary() { Release(); }
 
-template <typename K, typename V>
-Dictionary<K,V>::Dictionary(const Dictionary& other)
-  : data_(nullptr), size_(0), capacity_(0) {
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>::Dictionary(const Dictionary& other)
+  : data_(nullptr), size_(0), capacity_(0), slots_(nullptr), slot_count_(0),
+    max_load_factor_(other.max_load_factor_), hash_(other.hash_), equal_(other.equal_),
+    allocator_(AllocTraits::select_on_container_copy_construction(other.allocator_)) {
   EnsureCapacity(other.size_);
-  for (std::size_t i = 0; i < other.size_; ++i) data_[i] = other.data_[i];
-  size_ = other.size_;
+  try {
+    for (; size_ < other.size_; ++size_) new (data_ + size_) std::pair<K,V>(other.data_[size_]);
+    if (other.slot_count_ != 0) {
+      slots_ = AllocateSlots(other.slot_count_);
+      for (std::size_t i = 0; i < other.slot_count_; ++i) slots_[i] = other.slots_[i];
+      slot_count_ = other.slot_count_;
+    }
+  } catch (...) {
+    Release();
+    throw;
+  }
 }
 
-template <typename K, typename V>
-Dictionary<K,V>& Dictionary<K,V>::operator=(const Dictionary& other) {
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>& Dictionary<K,V,H,E,A>::operator=(const Dictionary& other) {
   if (this != &other) {
     Dictionary tmp(other);
     Swap(tmp);
@@ -30,104 +55,277 @@ Dictionary<K,V>& Dictionary<K,V>::operator=(const Dictionary& other) {
   return *this;
 }
 
-template <typename K, typename V>
-Dictionary<K,V>::Dictionary(Dictionary&& other) noexcept
-  : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>::Dictionary(Dictionary&& other) noexcept
+  : data_(other.data_), size_(other.size_), capacity_(other.capacity_),
+    slots_(other.slots_), slot_count_(other.slot_count_),
+    max_load_factor_(other.max_load_factor_), hash_(other.hash_), equal_(other.equal_),
+    allocator_(other.allocator_) {
   other.data_ = nullptr; other.size_ = 0; other.capacity_ = 0;
+  other.slots_ = nullptr; other.slot_count_ = 0;
 }
 
-template <typename K, typename V>
-Dictionary<K,V>& Dictionary<K,V>::operator=(Dictionary&& other) noexcept {
+template <typename K, typename V, typename H, typename E, typename A>
+Dictionary<K,V,H,E,A>& Dictionary<K,V,H,E,A>::operator=(Dictionary&& other) noexcept {
   if (this != &other) {
-    delete[] data_;
-    data_ = other.data_; size_ = other.size_; capacity_ = other.capacity_;
-    other.data_ = nullptr; other.size_ = 0; other.capacity_ = 0;
+    Clear();
+    Swap(other);
   }
   return *this;
 }
 
-template <typename K, typename V>
-std::size_t Dictionary<K,V>::Size() const { return size_; }
+template <typename K, typename V, typename H, typename E, typename A>
+std::size_t Dictionary<K,V,H,E,A>::Size() const { return size_; }
 
-template <typename K, typename V>
-bool Dictionary<K,V>::IsEmpty() const { return size_ == 0; }
+template <typename K, typename V, typename H, typename E, typename A>
+A Dictionary<K,V,H,E,A>::GetAllocator() const { return allocator_; }
 
-template <typename K, typename V>
-void Dictionary<K,V>::Add(const K& key, const V& value) {
-  std::size_t idx = FindIndex(key);
-  if (idx != static_cast<std::size_t>(-1)) {
-    data_[idx].second = value; // обновление
+template <typename K, typename V, typename H, typename E, typename A>
+bool Dictionary<K,V,H,E,A>::IsEmpty() const { return size_ == 0; }
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Add(const K& key, const V& value) {
+  std::uint32_t hash = HashOf(key);
+  std::size_t pos = FindSlot(key, hash);
+  if (pos != kNotFound) {
+    data_[slots_[pos].index - 1].second = value; // обновление
     return;
   }
-  EnsureCapacity(size_ + 1);
-  data_[size_++] = std::make_pair(key, value);
+  AppendNew(std::pair<K,V>(key, value), hash);
 }
 
-template <typename K, typename V>
-bool Dictionary<K,V>::Remove(const K& key) {
-  std::size_t idx = FindIndex(key);
-  if (idx == static_cast<std::size_t>(-1)) return false;
-  for (std::size_t i = idx; i + 1 < size_; ++i) data_[i] = data_[i+1];
-  --size_;
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Add(K&& key, V&& value) {
+  std::uint32_t hash = HashOf(key);
+  std::size_t pos = FindSlot(key, hash);
+  if (pos != kNotFound) {
+    data_[slots_[pos].index - 1].second = std::move(value);
+    return;
+  }
+  AppendNew(std::pair<K,V>(std::move(key), std::move(value)), hash);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+bool Dictionary<K,V,H,E,A>::Remove(const K& key) {
+  std::size_t pos = FindSlot(key, HashOf(key));
+  if (pos == kNotFound) return false;
+  RemoveAt(pos);
   return true;
 }
 
-template <typename K, typename V>
-bool Dictionary<K,V>::Contains(const K& key) const {
-  return FindIndex(key) != static_cast<std::size_t>(-1);
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::RemoveAt(std::size_t pos) {
+  std::size_t idx = slots_[pos].index - 1;
+  EraseSlot(pos);
+  std::size_t last = size_ - 1;
+  if (idx != last) {
+    // Последняя пара переезжает в освободившуюся позицию — исправляем её ячейку.
+    std::size_t moved = FindSlot(data_[last].first, HashOf(data_[last].first));
+    slots_[moved].index = static_cast<std::uint32_t>(idx + 1);
+    data_[idx] = std::move(data_[last]);
+  }
+  data_[last].~pair();
+  --size_;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+bool Dictionary<K,V,H,E,A>::Contains(const K& key) const {
+  return FindIndex(key) != kNotFound;
 }
 
-template <typename K, typename V>
-V* Dictionary<K,V>::Get(const K& key) {
+template <typename K, typename V, typename H, typename E, typename A>
+V* Dictionary<K,V,H,E,A>::Get(const K& key) {
   std::size_t idx = FindIndex(key);
-  if (idx == static_cast<std::size_t>(-1)) return nullptr;
+  if (idx == kNotFound) return nullptr;
   return &data_[idx].second;
 }
 
-template <typename K, typename V>
-const V* Dictionary<K,V>::Get(const K& key) const {
+template <typename K, typename V, typename H, typename E, typename A>
+const V* Dictionary<K,V,H,E,A>::Get(const K& key) const {
   std::size_t idx = FindIndex(key);
-  if (idx == static_cast<std::size_t>(-1)) return nullptr;
+  if (idx == kNotFound) return nullptr;
   return &data_[idx].second;
 }
 
-template <typename K, typename V>
-std::vector<std::pair<K,V>> Dictionary<K,V>::ToVector() const {
+template <typename K, typename V, typename H, typename E, typename A>
+typename Dictionary<K,V,H,E,A>::const_iterator Dictionary<K,V,H,E,A>::begin() const { return data_; }
+
+template <typename K, typename V, typename H, typename E, typename A>
+typename Dictionary<K,V,H,E,A>::const_iterator Dictionary<K,V,H,E,A>::end() const { return data_ + size_; }
+
+template <typename K, typename V, typename H, typename E, typename A>
+std::vector<std::pair<K,V>> Dictionary<K,V,H,E,A>::ToVector() const {
   return std::vector<std::pair<K,V>>(data_, data_ + size_);
 }
 
-template <typename K, typename V>
-void Dictionary<K,V>::Clear() {
-  delete[] data_;
-  data_ = nullptr; size_ = 0; capacity_ = 0;
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Clear() { Release(); }
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Reserve(std::size_t count) {
+  if (count <= size_) return;
+  EnsureCapacity(count);
+  std::size_t needed = SlotsFor(count);
+  if (needed > slot_count_) Rehash(needed);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::ShrinkToFit() {
+  if (size_ == 0) {
+    Release();
+    return;
+  }
+  if (size_ < capacity_) Reallocate(size_);
+  std::size_t needed = SlotsFor(size_);
+  if (needed < slot_count_) Rehash(needed);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+float Dictionary<K,V,H,E,A>::LoadFactor() const {
+  return slot_count_ == 0 ? 0.0f : static_cast<float>(size_) / static_cast<float>(slot_count_);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+float Dictionary<K,V,H,E,A>::MaxLoadFactor() const { return max_load_factor_; }
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::SetMaxLoadFactor(float max_load_factor) {
+  if (max_load_factor < 0.25f) max_load_factor = 0.25f;
+  if (max_load_factor > 0.95f) max_load_factor = 0.95f;
+  max_load_factor_ = max_load_factor;
+  if (size_ != 0) Rehash(SlotsFor(size_));
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+std::size_t Dictionary<K,V,H,E,A>::SlotsFor(std::size_t count) const {
+  std::size_t slots = 8;
+  while (static_cast<float>(count) > max_load_factor_ * static_cast<float>(slots)) slots *= 2;
+  return slots;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::InsertSlot(std::uint32_t index, std::uint32_t hash) {
+  std::size_t mask = slot_count_ - 1;
+  Slot incoming{index, hash};
+  std::size_t pos = hash & mask;
+  for (std::size_t dist = 0;; ++dist, pos = (pos + 1) & mask) {
+    Slot& slot = slots_[pos];
+    if (slot.index == 0) {
+      slot = incoming;
+      return;
+    }
+    std::size_t slot_dist = (pos - slot.hash) & mask;
+    if (slot_dist < dist) {
+      // «Богатый» элемент уступает место «бедному».
+      std::swap(slot, incoming);
+      dist = slot_dist;
+    }
+  }
 }
 
-template <typename K, typename V>
-std::size_t Dictionary<K,V>::FindIndex(const K& key) const {
-  for (std::size_t i = 0; i < size_; ++i) if (data_[i].first == key) return i;
-  return static_cast<std::size_t>(-1);
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::EraseSlot(std::size_t pos) {
+  std::size_t mask = slot_count_ - 1;
+  std::size_t next = (pos + 1) & mask;
+  while (slots_[next].index != 0 && ((next - slots_[next].hash) & mask) != 0) {
+    slots_[pos] = slots_[next];
+    pos = next;
+    next = (next + 1) & mask;
+  }
+  slots_[pos].index = 0;
 }
 
-template <typename K, typename V>
-void Dictionary<K,V>::EnsureCapacity(std::size_t min_capacity) {
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Rehash(std::size_t min_slots) {
+  std::size_t new_count = 8;
+  while (new_count < min_slots) new_count *= 2;
+  if (new_count > slot_count_) METRICS_ADD(kContainerGrowths, 1);
+  Slot* old_slots = slots_;
+  std::size_t old_count = slot_count_;
+  slots_ = AllocateSlots(new_count);
+  slot_count_ = new_count;
+  for (std::size_t i = 0; i < old_count; ++i) {
+    if (old_slots[i].index != 0) InsertSlot(old_slots[i].index, old_slots[i].hash);
+  }
+  DeallocateSlots(old_slots, old_count);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+typename Dictionary<K,V,H,E,A>::Slot* Dictionary<K,V,H,E,A>::AllocateSlots(std::size_t count) {
+  SlotAllocator allocator(allocator_);
+  Slot* slots = SlotTraits::allocate(allocator, count);
+  std::memset(static_cast<void*>(slots), 0, count * sizeof(Slot));
+  return slots;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::DeallocateSlots(Slot* slots, std::size_t count) noexcept {
+  if (slots == nullptr) return;
+  SlotAllocator allocator(allocator_);
+  SlotTraits::deallocate(allocator, slots, count);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::EnsureCapacity(std::size_t min_capacity) {
   if (capacity_ >= min_capacity) return;
+  METRICS_ADD(kContainerGrowths, 1);
   std::size_t new_capacity = capacity_ == 0 ? kInitialCapacity : capacity_ * 2;
   while (new_capacity < min_capacity) new_capacity *= 2;
-  std::pair<K,V>* new_data = new std::pair<K,V>[new_capacity];
-  for (std::size_t i = 0; i < size_; ++i) new_data[i] = data_[i];
-  delete[] data_;
+  Reallocate(new_capacity);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Reallocate(std::size_t new_capacity) {
+  std::pair<K,V>* new_data = AllocTraits::allocate(allocator_, new_capacity);
+  // Пары перемещаются в неинициализированную память, старые сразу разрушаются.
+  for (std::size_t i = 0; i < size_; ++i) {
+    new (new_data + i) std::pair<K,V>(std::move_if_noexcept(data_[i]));
+    data_[i].~pair();
+  }
+  if (data_ != nullptr) AllocTraits::deallocate(allocator_, data_, capacity_);
   data_ = new_data;
   capacity_ = new_capacity;
 }
 
-template <typename K, typename V>
-void Dictionary<K,V>::Swap(Dictionary& other) noexcept {
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Release() noexcept {
+  for (std::size_t i = 0; i < size_; ++i) data_[i].~pair();
+  if (data_ != nullptr) AllocTraits::deallocate(allocator_, data_, capacity_);
+  DeallocateSlots(slots_, slot_count_);
+  data_ = nullptr; size_ = 0; capacity_ = 0;
+  slots_ = nullptr; slot_count_ = 0;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::AppendNew(std::pair<K,V>&& entry, std::uint32_t hash) {
+  if (static_cast<float>(size_ + 1) > max_load_factor_ * static_cast<float>(slot_count_)) {
+    Rehash(SlotsFor(size_ + 1));
+  }
+  EnsureCapacity(size_ + 1);
+  new (data_ + size_) std::pair<K,V>(std::move(entry));
+  InsertSlot(static_cast<std::uint32_t>(size_ + 1), hash);
+  ++size_;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+void Dictionary<K,V,H,E,A>::Swap(Dictionary& other) noexcept {
   std::swap(data_, other.data_);
   std::swap(size_, other.size_);
   std::swap(capacity_, other.capacity_);
+  std::swap(slots_, other.slots_);
+  std::swap(slot_count_, other.slot_count_);
+  std::swap(max_load_factor_, other.max_load_factor_);
+  std::swap(hash_, other.hash_);
+  std::swap(equal_, other.equal_);
+  std::swap(allocator_, other.allocator_);
 }
 
 // --- явные инстанциации ---
 // Добавьте сюда новые инстанциации, если будете использовать другие комбинации типов.
 template class Dictionary<std::string, long long>;
-template class Dictionary<std::string, int>;
\ No newline at end of file
+template class Dictionary<std::string, int>;
+template class Dictionary<std::string, std::size_t>;
+template class Dictionary<std::string_view, std::uint32_t>;
+template class Dictionary<std::string, long long, StringHash, StringEqual>;
+template class Dictionary<std::string, int, std::hash<std::string>, std::equal_to<std::string>,
+                          PoolAllocator<std::pair<std::string, int>>>;
@@ -1,16 +1,54 @@
 #ifndef DICTIONARY_H_
 #define DICTIONARY_H_
 
+#include "metrics.h"
+#include "string_hash.h"
+
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <utility>
 
 /// <summary>Простой универсальный словарь (ключ -> значение) без использования std::map / std::unordered_map.</summary>
-/// <remarks>Хранит пары в динамическом массиве. Ключи уникальны.</remarks>
-template <typename K, typename V>
+/// <remarks>Хранит пары в плотном динамическом массиве в порядке добавления. Ключи уникальны.
+/// Поиск — хеш-таблица Robin Hood: ячейка хранит индекс пары и 32 бита хеша ключа,
+/// длина пробы вычисляется из хеша, удаление — обратным сдвигом (без «надгробий»).
+/// Вместимость ограничена 2^32 - 1 парами. Массив пар — неинициализированная память:
+/// пары конструируются при добавлении и перемещаются при росте.
+/// Итераторы (begin/end) — константные указатели на пары в порядке хранения. Добавление
+/// нового ключа, Reserve, ShrinkToFit, Clear и присваивание делают их недействительными;
+/// Remove — итераторы на удалённую и последнюю пару и end(). Обновление значения
+/// существующего ключа через Add итераторы не затрагивает.
+/// Allocator выделяет массив пар, а через rebind — и таблицу ячеек. Как и у UnorderedSet,
+/// аллокатор переходит вместе с содержимым при перемещении и обмене, а копия получает
+/// select_on_container_copy_construction().
+/// С прозрачными Hash и KeyEqual (StringHash, StringEqual) Contains, Get, Remove и Add ищут
+/// по ключу другого типа — Dictionary<std::string, V, StringHash, StringEqual> принимает
+/// std::string_view и const char* без временной строки.</remarks>
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Allocator = std::allocator<std::pair<K,V>>>
 class Dictionary {
  public:
+  using value_type = std::pair<K,V>;
+  using size_type = std::size_t;
+  using const_iterator = const std::pair<K,V>*;
+  using iterator = const_iterator;
+  using allocator_type = Allocator;
+
+  /// <summary>Тип R, если Hash и KeyEqual прозрачны, а Key — не K (его принимают обычные
+  /// перегрузки); иначе перегрузка для ключа Key скрыта.</summary>
+  template <typename Key, typename R>
+  using IfTransparent = std::enable_if_t<
+      IsTransparentLookup<Hash, KeyEqual, Key>::value && !std::is_same<Key, K>::value, R>;
+
   Dictionary();
+  explicit Dictionary(const Allocator& allocator);
+  explicit Dictionary(const Hash& hash, const KeyEqual& equal = KeyEqual(),
+                      const Allocator& allocator = Allocator());
   ~Dictionary();
 
   Dictionary(const Dictionary& other);
@@ -20,34 +58,223 @@ class Dictionary {
 
   std::size_t Size() const;
   bool IsEmpty() const;
+  Allocator GetAllocator() const;
 
   /// <summary>Добавляет пару (key,value). Если ключ уже существует — обновляет значение.</summary>
   void Add(const K& key, const V& value);
 
-  /// <summary>Удаляет элемент по ключу. Возвращает true, если удалено.</summary>
+  /// <summary>Add с перемещением ключа и значения.</summary>
+  void Add(K&& key, V&& value);
+
+  /// <summary>Add по прозрачному ключу: K(key) строится, только если ключа ещё нет.</summary>
+  /// <remarks>Значение передаётся пробросом, чтобы Add("ключ", 1) не был неоднозначен с
+  /// Add(K&amp;&amp;, V&amp;&amp;).</remarks>
+  template <typename Key, typename Value>
+  IfTransparent<Key, void> Add(const Key& key, Value&& value);
+
+  /// <summary>Добавляет пару, конструируя значение из args, только если ключа ещё нет.</summary>
+  /// <returns>true, если пара добавлена; false, если ключ уже был (значение не меняется).</returns>
+  template <typename... Args>
+  bool Emplace(const K& key, Args&&... args);
+
+  /// <summary>Удаляет элемент по ключу за O(1). Возвращает true, если удалено.</summary>
+  /// <remarks>На место удалённой пары переносится последняя, порядок ToVector может измениться.</remarks>
   bool Remove(const K& key);
 
+  /// <summary>Remove по прозрачному ключу.</summary>
+  template <typename Key>
+  IfTransparent<Key, bool> Remove(const Key& key);
+
   /// <summary>Проверяет наличие ключа.</summary>
   bool Contains(const K& key) const;
 
+  /// <summary>Contains по прозрачному ключу, без выделения памяти.</summary>
+  template <typename Key>
+  IfTransparent<Key, bool> Contains(const Key& key) const;
+
   /// <summary>Возвращает указатель на значение по ключу или nullptr, если нет.</summary>
+  /// <remarks>Указатель действителен до следующего Add/Remove/Reserve.</remarks>
   V* Get(const K& key);
   const V* Get(const K& key) const;
 
+  /// <summary>Get по прозрачному ключу, без выделения памяти.</summary>
+  template <typename Key>
+  IfTransparent<Key, V*> Get(const Key& key);
+  template <typename Key>
+  IfTransparent<Key, const V*> Get(const Key& key) const;
+
+  /// <summary>Итераторы по парам без копирования.</summary>
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  /// <summary>Вызывает visitor(ключ, значение) для каждой пары в порядке хранения.</summary>
+  template <typename Visitor>
+  void ForEach(Visitor visitor) const;
+
   /// <summary>Возвращает все пары в виде вектора (копии).</summary>
   std::vector<std::pair<K,V>> ToVector() const;
 
   void Clear();
 
+  /// <summary>Заранее выделяет место под count пар, чтобы избежать перестроек таблицы.</summary>
+  void Reserve(std::size_t count);
+
+  /// <summary>Освобождает лишнюю память: массив пар ужимается до Size(), таблица — до минимальной.</summary>
+  void ShrinkToFit();
+
+  /// <summary>Текущая заполненность хеш-таблицы (Size / число ячеек).</summary>
+  float LoadFactor() const;
+
+  /// <summary>Максимальная заполненность, при превышении которой таблица удваивается.</summary>
+  float MaxLoadFactor() const;
+
+  /// <summary>Задаёт максимальную заполненность (ограничивается диапазоном [0.25, 0.95]).</summary>
+  /// <remarks>При необходимости таблица сразу перестраивается.</remarks>
+  void SetMaxLoadFactor(float max_load_factor);
+
  private:
   static constexpr std::size_t kInitialCapacity = 4;
+  static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+  static constexpr float kDefaultMaxLoadFactor = 0.875f;
+
+  /// <summary>Ячейка таблицы: index == 0 — пусто, иначе индекс пары в data_ плюс один.</summary>
+  struct Slot {
+    std::uint32_t index;
+    std::uint32_t hash;
+  };
+
+  using AllocTraits = std::allocator_traits<Allocator>;
+  using SlotAllocator = typename AllocTraits::template rebind_alloc<Slot>;
+  using SlotTraits = std::allocator_traits<SlotAllocator>;
+
   std::pair<K,V>* data_;
   std::size_t size_;
   std::size_t capacity_;
+  Slot* slots_;
+  std::size_t slot_count_;
+  float max_load_factor_;
+  Hash hash_;
+  KeyEqual equal_;
+  Allocator allocator_;
 
   void EnsureCapacity(std::size_t min_capacity);
-  std::size_t FindIndex(const K& key) const;
+  void Reallocate(std::size_t new_capacity);
+  void Release() noexcept;
+  void Rehash(std::size_t min_slots);
+  /// <summary>Выделяет count обнуленных ячеек.</summary>
+  Slot* AllocateSlots(std::size_t count);
+  void DeallocateSlots(Slot* slots, std::size_t count) noexcept;
+  std::size_t SlotsFor(std::size_t count) const;
+  template <typename Key>
+  std::uint32_t HashOf(const Key& key) const;
+  template <typename Key>
+  std::size_t FindSlot(const Key& key, std::uint32_t hash) const;
+  template <typename Key>
+  std::size_t FindIndex(const Key& key) const;
+  /// <summary>Удаляет пару, на которую ссылается ячейка pos; на её место переезжает последняя.</summary>
+  void RemoveAt(std::size_t pos);
+  void InsertSlot(std::uint32_t index, std::uint32_t hash);
+  void EraseSlot(std::size_t pos);
+  /// <summary>Добавляет пару с заведомо отсутствующим ключом.</summary>
+  void AppendNew(std::pair<K,V>&& entry, std::uint32_t hash);
   void Swap(Dictionary& other) noexcept;
 };
 
-#endif // DICTIONARY_H_
\ No newline at end of file
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Visitor>
+void Dictionary<K,V,H,E,A>::ForEach(Visitor visitor) const {
+  for (std::size_t i = 0; i < size_; ++i) visitor(data_[i].first, data_[i].second);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename... Args>
+bool Dictionary<K,V,H,E,A>::Emplace(const K& key, Args&&... args) {
+  std::uint32_t hash = HashOf(key);
+  if (FindSlot(key, hash) != kNotFound) return false;
+  // Пара собирается до роста массива: аргументы могут ссылаться на его элементы.
+  AppendNew(std::pair<K,V>(std::piecewise_construct, std::forward_as_tuple(key),
+                           std::forward_as_tuple(std::forward<Args>(args)...)), hash);
+  return true;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key, typename Value>
+typename Dictionary<K,V,H,E,A>::template IfTransparent<Key, void>
+Dictionary<K,V,H,E,A>::Add(const Key& key, Value&& value) {
+  std::uint32_t hash = HashOf(key);
+  std::size_t pos = FindSlot(key, hash);
+  if (pos != kNotFound) {
+    data_[slots_[pos].index - 1].second = std::forward<Value>(value);
+    return;
+  }
+  AppendNew(std::pair<K,V>(K(key), V(std::forward<Value>(value))), hash);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key>
+typename Dictionary<K,V,H,E,A>::template IfTransparent<Key, bool>
+Dictionary<K,V,H,E,A>::Remove(const Key& key) {
+  std::size_t pos = FindSlot(key, HashOf(key));
+  if (pos == kNotFound) return false;
+  RemoveAt(pos);
+  return true;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key>
+typename Dictionary<K,V,H,E,A>::template IfTransparent<Key, bool>
+Dictionary<K,V,H,E,A>::Contains(const Key& key) const {
+  return FindIndex(key) != kNotFound;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key>
+typename Dictionary<K,V,H,E,A>::template IfTransparent<Key, V*>
+Dictionary<K,V,H,E,A>::Get(const Key& key) {
+  std::size_t idx = FindIndex(key);
+  if (idx == kNotFound) return nullptr;
+  return &data_[idx].second;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key>
+typename Dictionary<K,V,H,E,A>::template IfTransparent<Key, const V*>
+Dictionary<K,V,H,E,A>::Get(const Key& key) const {
+  std::size_t idx = FindIndex(key);
+  if (idx == kNotFound) return nullptr;
+  return &data_[idx].second;
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key>
+std::uint32_t Dictionary<K,V,H,E,A>::HashOf(const Key& key) const {
+  // Перемешиваем биты: std::hash для целых — тождественная функция.
+  unsigned long long h = static_cast<unsigned long long>(hash_(key));
+  h ^= h >> 32;
+  h *= 0x9E3779B97F4A7C15ULL;
+  return static_cast<std::uint32_t>(h >> 32);
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key>
+std::size_t Dictionary<K,V,H,E,A>::FindSlot(const Key& key, std::uint32_t hash) const {
+  if (slot_count_ == 0) return kNotFound;
+  std::size_t mask = slot_count_ - 1;
+  std::size_t pos = hash & mask;
+  for (std::size_t dist = 0;; ++dist, pos = (pos + 1) & mask) {
+    const Slot& slot = slots_[pos];
+    // Инвариант Robin Hood: если «чужой» элемент ближе к дому, чем мы, искомого ключа нет.
+    if (slot.index == 0 || ((pos - slot.hash) & mask) < dist) { METRICS_PROBE(dist + 1); return kNotFound; }
+    if (slot.hash == hash && equal_(data_[slot.index - 1].first, key)) { METRICS_PROBE(dist + 1); return pos; }
+  }
+}
+
+template <typename K, typename V, typename H, typename E, typename A>
+template <typename Key>
+std::size_t Dictionary<K,V,H,E,A>::FindIndex(const Key& key) const {
+  std::size_t pos = FindSlot(key, HashOf(key));
+  if (pos == kNotFound) return kNotFound;
+  return slots_[pos].index - 1;
+}
+
+#endif // DICTIONARY_H_
@@ -1,300 +1,104 @@
-#include "dictionary.h"
+#include "book_analyzer.h"
+#include "competition.h"
+#include "metrics.h"
 #include "unordered_set.h"
-#include "utils.h"
 
-#include <algorithm>
-#include <fstream>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <limits>
-#include <string>
-#include <vector>
 
-/// <summary>Класс для анализа прочитанных книг читателями.</summary>
-/// <remarks>
-/// Использует класс UnorderedSet для хранения книг и выполнения операций над
-/// множествами. Определяет три категории книг: прочитанные всеми, прочитанные
-/// некоторыми, не прочитанные никем.
-/// </remarks>
-class BookAnalyzer {
-public:
-  /// <summary>Читает данные из файла и заполняет внутренние
-  /// структуры.</summary> <param name="filename">Имя файла с данными.</param>
-  /// <returns>true, если данные успешно прочитаны, иначе false.</returns>
-  bool ReadData(const std::string &filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-      std::cerr << "Ошибка: не удалось открыть файл " << filename << std::endl;
-      return false;
-    }
-
-    std::string line;
-    bool reading_books = true;
-
-    while (std::getline(file, line)) {
-      std::string trimmed = Trim(line);
-
-      if (trimmed.empty()) {
-        reading_books = false;
-        continue;
-      }
-
-      if (reading_books) {
-        all_books_.Add(trimmed);
-      } else {
-        UnorderedSet<std::string> reader_books;
-        std::vector<std::string> books = Split(trimmed, ';');
-
-        for (const auto &book : books) {
-          reader_books.Add(book);
-          all_books_.Add(book);
-        }
-
-        readers_books_.push_back(std::move(reader_books));
-      }
-    }
-
-    file.close();
-    return true;
-  }
-
-  /// <summary>Выполняет анализ прочитанных книг.</summary>
-  /// <remarks>
-  /// Определяет три категории книг:
-  /// 1. Книги, прочитанные всеми читателями
-  /// 2. Книги, прочитанные некоторыми читателями (но не всеми)
-  /// 3. Книги, которые никто не прочитал
-  /// </remarks>
-  void Analyze() {
-    if (readers_books_.empty()) {
-      std::cout << "Нет данных о читателях" << std::endl;
-      return;
-    }
-
-    books_read_by_all_ = readers_books_[0];
-    for (std::size_t i = 1; i < readers_books_.size(); ++i) {
-      books_read_by_all_ = books_read_by_all_.Intersect(readers_books_[i]);
-    }
-
-    books_read_by_someone_ = readers_books_[0];
-    for (std::size_t i = 1; i < readers_books_.size(); ++i) {
-      books_read_by_someone_ = books_read_by_someone_.Union(readers_books_[i]);
-    }
-
-    books_read_by_some_ = books_read_by_someone_.Except(books_read_by_all_);
-
-    books_read_by_none_ = all_books_.Except(books_read_by_someone_);
-  }
-
-  /// <summary>Выводит результаты анализа в консоль.</summary>
-  void PrintResults() const {
-    std::cout << "Всего книг в каталоге: " << all_books_.Size() << std::endl;
-    std::cout << "Количество читателей: " << readers_books_.size() << "\n"
+namespace {
+
+/// <summary>Сохраняет метрики, если они запрошены.</summary>
+/// <param name="filename">Имя файла или nullptr.</param>
+void SaveMetrics(const char *filename) {
+  if (filename == nullptr)
+    return;
+  if (!MetricsEnabled()) {
+    std::cerr << "Метрики не собраны в программу (нужен -DENABLE_METRICS)\n";
+  } else if (!WriteMetricsJson(filename)) {
+    std::cerr << "Ошибка: не удалось записать метрики в файл " << filename
               << std::endl;
-
-    PrintSet("Книги, прочитанные ВСЕМИ читателями:", books_read_by_all_);
-    PrintSet("Книги, прочитанные НЕКОТОРЫМИ читателями (но не всеми):",
-             books_read_by_some_);
-    PrintSet("Книги, которые НИКТО не прочитал:", books_read_by_none_);
-  }
-
-  /// <summary>Сохраняет результаты анализа в файл.</summary>
-  /// <param name="filename">Имя файла для сохранения результатов.</param>
-  void SaveResults(const std::string &filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-      std::cerr << "Ошибка: не удалось создать файл " << filename << std::endl;
-      return;
-    }
-
-    file << "Всего книг в каталоге: " << all_books_.Size() << "\n";
-    file << "Количество читателей: " << readers_books_.size() << "\n\n";
-
-    SaveSetToFile(file,
-                  "Книги, прочитанные ВСЕМИ читателями:", books_read_by_all_);
-    SaveSetToFile(file,
-                  "Книги, прочитанные НЕКОТОРЫМИ читателями (но не всеми):",
-                  books_read_by_some_);
-    SaveSetToFile(file,
-                  "Книги, которые НИКТО не прочитал:", books_read_by_none_);
-
-    file.close();
-    std::cout << "\nРезультаты сохранены в файл: " << filename << std::endl;
-  }
-
-private:
-  UnorderedSet<std::string> all_books_;
-  std::vector<UnorderedSet<std::string>> readers_books_;
-  UnorderedSet<std::string> books_read_by_all_;
-  UnorderedSet<std::string> books_read_by_some_;
-  UnorderedSet<std::string> books_read_by_none_;
-  UnorderedSet<std::string> books_read_by_someone_;
-
-  /// <summary>Выводит множество книг с заголовком в консоль.</summary>
-  /// <param name="title">Заголовок для вывода.</param>
-  /// <param name="set">Множество книг для вывода.</param>
-  void PrintSet(const std::string &title,
-                const UnorderedSet<std::string> &set) const {
-    std::cout << title << std::endl;
-    std::cout << "Количество: " << set.Size() << std::endl;
-
-    auto books = set.ToVector();
-    if (books.empty()) {
-      std::cout << "  (нет книг)\n" << std::endl;
-    } else {
-      for (const auto &book : books) {
-        std::cout << "  • " << book << std::endl;
-      }
-      std::cout << std::endl;
-    }
-  }
-
-  /// <summary>Сохраняет множество книг с заголовком в файл.</summary>
-  /// <param name="file">Файловый поток для записи.</param>
-  /// <param name="title">Заголовок для сохранения.</param>
-  /// <param name="set">Множество книг для сохранения.</param>
-  void SaveSetToFile(std::ofstream &file, const std::string &title,
-                     const UnorderedSet<std::string> &set) const {
-    file << title << "\n";
-    file << "Количество: " << set.Size() << "\n";
-
-    auto books = set.ToVector();
-    if (books.empty()) {
-      file << "  (нет книг)\n\n";
-    } else {
-      for (const auto &book : books) {
-        file << "  • " << book << "\n";
-      }
-      file << "\n";
-    }
-  }
-};
-
-/// <summary>Структура для хранения информации о спортсмене.</summary>
-/// <remarks>Используется в задаче многоборья.</remarks>
-struct Athlete {
-  std::string surname;
-  std::string name;
-  long long sum;
-  std::size_t input_index;
-};
-
-/// <summary>Читает входные данные многоборья из файла, сортирует спортсменов и
-/// сохраняет результаты.</summary> <param name="infile">Имя входного файла
-/// (например, input2.txt).</param> <param name="outfile">Имя выходного файла
-/// (например, output2.txt).</param> <returns>true, если успешно, иначе
-/// false.</returns>
-bool RunCompetition(const std::string &infile, const std::string &outfile) {
-  std::ifstream in(infile);
-  if (!in.is_open()) {
-    std::cerr << "Не удалось открыть файл " << infile << std::endl;
-    return false;
   }
+}
 
-  int N = 0, M = 0;
-  if (!(in >> N)) {
-    std::cerr << "Ошибка чтения N из " << infile << std::endl;
+/// <summary>Разбирает положительное целое число из аргумента.</summary>
+/// <param name="text">Аргумент командной строки.</param>
+/// <param name="value">Результат.</param>
+/// <returns>false, если аргумент не число целиком или равен нулю.</returns>
+bool ParsePositive(const char *text, std::size_t &value) {
+  if (*text < '0' || *text > '9')
     return false;
-  }
-  if (!(in >> M)) {
-    std::cerr << "Ошибка чтения M из " << infile << std::endl;
+  errno = 0;
+  char *end = nullptr;
+  unsigned long long parsed = std::strtoull(text, &end, 10);
+  if (errno != 0 || *end != '\0' || parsed == 0)
     return false;
-  }
-  if (N < 0 || N >= 1000) {
-    std::cerr << "N вне допустимого диапазона (0..999)\n";
-    return false;
-  }
-  if (M < 0) {
-    std::cerr << "M некорректно\n";
-    return false;
-  }
-
-  std::vector<Athlete> athletes;
-  athletes.reserve(static_cast<std::size_t>(N));
-
-  for (int i = 0; i < N; ++i) {
-    std::string surname, name;
-    if (!(in >> surname >> name)) {
-      std::cerr << "Ошибка чтения Фамилии/Имени спортсмена на строке "
-                << (i + 1) << std::endl;
-      return false;
-    }
-    long long sum = 0;
-    for (int j = 0; j < M; ++j) {
-      long long x;
-      if (!(in >> x)) {
-        std::cerr << "Ошибка чтения баллов у " << surname << " " << name
-                  << std::endl;
-        return false;
-      }
-      sum += x;
-    }
-    athletes.push_back({surname, name, sum, static_cast<std::size_t>(i)});
-  }
-
-  // Сортировка по убыванию суммы, стабильная (сохранение порядка при равных
-  // суммах).
-  std::stable_sort(
-      athletes.begin(), athletes.end(),
-      [](const Athlete &a, const Athlete &b) { return a.sum > b.sum; });
-
-  // Присвоение плотных мест: 1,1,2,...
-  std::vector<int> rank(athletes.size());
-  long long prev_sum = std::numeric_limits<long long>::min();
-  int dense_rank = 0;
-  for (std::size_t i = 0; i < athletes.size(); ++i) {
-    if (athletes[i].sum != prev_sum) {
-      ++dense_rank;
-      prev_sum = athletes[i].sum;
-    }
-    rank[i] = dense_rank;
-  }
-
-  // Вывод в консоль
-  std::cout << "\nРезультаты многоборья (из " << N << " спортсменов, " << M
-            << " видов):\n";
-  for (std::size_t i = 0; i < athletes.size(); ++i) {
-    std::cout << athletes[i].surname << ' ' << athletes[i].name << ' '
-              << athletes[i].sum << ' ' << rank[i] << '\n';
-  }
-
-  // Сохранение в outfile
-  std::ofstream out(outfile);
-  if (out.is_open()) {
-    for (std::size_t i = 0; i < athletes.size(); ++i) {
-      out << athletes[i].surname << ' ' << athletes[i].name << ' '
-          << athletes[i].sum << ' ' << rank[i] << '\n';
-    }
-    out.close();
-    std::cout << "\nРезультаты многоборья сохранены в файл: " << outfile
-              << std::endl;
-  } else {
-    std::cerr << "Не удалось создать файл " << outfile
-              << " для записи результатов\n";
-  }
-
+  value = static_cast<std::size_t>(parsed);
   return true;
 }
 
+} // namespace
+
 /// <summary>Главная функция программы.</summary>
+/// <param name="argc">Число аргументов.</param>
+/// <param name="argv">Аргументы: "--metrics файл" сохраняет время этапов и
+/// счетчики в JSON; "--load-snapshot файл" берет данные о книгах из снимка
+/// вместо input.txt; "--save-snapshot файл" сохраняет снимок после
+/// анализа; "--max-athletes N" задает ограничение на число спортсменов в
+/// input2.txt (по умолчанию CompetitionOptions::max_athletes = 1000,
+/// допускается N меньше этого значения).</param>
 /// <returns>Код завершения программы: 0 - успешно, другие значения -
 /// ошибка.</returns> <remarks> Выполняет два независимых сценария:
 /// 1. Анализ прочитанных книг (читает input.txt, сохраняет output.txt)
 /// 2. Задача многоборья (читает input2.txt, сохраняет output2.txt)
 /// </remarks>
-int main() {
-  // 1) Анализ книг: input.txt -> output.txt
+int main(int argc, char *argv[]) {
+  const char *metrics_file = nullptr;
+  const char *load_snapshot = nullptr;
+  const char *save_snapshot = nullptr;
+  CompetitionOptions competition_options;
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::strcmp(argv[i], "--metrics") == 0)
+      metrics_file = argv[++i];
+    else if (std::strcmp(argv[i], "--load-snapshot") == 0)
+      load_snapshot = argv[++i];
+    else if (std::strcmp(argv[i], "--save-snapshot") == 0)
+      save_snapshot = argv[++i];
+    else if (std::strcmp(argv[i], "--max-athletes") == 0) {
+      const char *value = argv[++i];
+      if (!ParsePositive(value, competition_options.max_athletes)) {
+        std::cerr << "Ошибка: --max-athletes ожидает положительное число, "
+                     "а не "
+                  << value << std::endl;
+        return 2;
+      }
+    }
+  }
+
+  // 1) Анализ книг: input.txt (или снимок) -> output.txt
   BookAnalyzer analyzer;
-  if (!analyzer.ReadData("input.txt")) {
-    std::cerr << "Завершение: ошибка при чтении input.txt\n";
+  bool books_ok = load_snapshot != nullptr
+                      ? analyzer.LoadSnapshot(load_snapshot)
+                      : analyzer.ReadData("input.txt");
+  if (!books_ok) {
+    std::cerr << "Завершение: ошибка при чтении "
+              << (load_snapshot != nullptr ? load_snapshot : "input.txt")
+              << "\n";
     // не прерываем — всё ещё хотим попытаться выполнить задачу многоборья
   } else {
     analyzer.Analyze();
-    analyzer.PrintResults();
-    analyzer.SaveResults("output.txt");
+    analyzer.PrintAndSaveResults("output.txt");
+    if (save_snapshot != nullptr)
+      analyzer.SaveSnapshot(save_snapshot);
   }
 
   // 2) Многоборье: input2.txt -> output2.txt
-  if (!RunCompetition("input2.txt", "output2.txt")) {
+  bool competition_ok = RunCompetition("input2.txt", "output2.txt",
+                                       competition_options);
+  SaveMetrics(metrics_file);
+  if (!competition_ok) {
     std::cerr
         << "Ошибка при выполнении задачи многоборья. Проверьте input2.txt\n";
     return 1;
@@ -310,7 +114,7 @@ int main() {
   set1.Add(3);
   set1.Add(2);
   std::cout << "set1 содержит: ";
-  for (int num : set1.ToVector()) {
+  for (int num : set1) {
     std::cout << num << " ";
   }
   std::cout << "\nРазмер set1: " << set1.Size() << std::endl;
@@ -320,7 +124,7 @@ int main() {
   set2.Add(4);
   set2.Add(5);
   std::cout << "set2 содержит: ";
-  for (int num : set2.ToVector()) {
+  for (int num : set2) {
     std::cout << num << " ";
   }
   std::cout << "\nРазмер set2: " << set2.Size() << std::endl;
@@ -335,21 +139,21 @@ int main() {
 
   auto union_set = set1.Union(set2);
   std::cout << "Объединение (Union): ";
-  for (int num : union_set.ToVector()) {
+  for (int num : union_set) {
     std::cout << num << " ";
   }
   std::cout << std::endl;
 
   auto intersect_set = set1.Intersect(set2);
   std::cout << "Пересечение (Intersect): ";
-  for (int num : intersect_set.ToVector()) {
+  for (int num : intersect_set) {
     std::cout << num << " ";
   }
   std::cout << std::endl;
 
   auto except_set = set1.Except(set2);
   std::cout << "Разность (Except): ";
-  for (int num : except_set.ToVector()) {
+  for (int num : except_set) {
     std::cout << num << " ";
   }
   std::cout << std::endl;
@@ -357,7 +161,7 @@ int main() {
   std::cout << "\nУдаление элемента 3 из set1:" << std::endl;
   set1.Remove(3);
   std::cout << "set1 после удаления: ";
-  for (int num : set1.ToVector()) {
+  for (int num : set1) {
     std::cout << num << " ";
   }
   std::cout << "\nРазмер set1: " << set1.Size() << std::endl;
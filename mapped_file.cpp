@@ -0,0 +1,76 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : data_(nullptr), size_(0), open_(false), mapped_(false), buffer_() {}
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string &filename) {
+  Close();
+#if defined(MAPPED_FILE_HAS_MMAP)
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) {
+      ::close(fd);
+      open_ = true;
+      return true;
+    }
+    void *addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr != MAP_FAILED) {
+      ::madvise(addr, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(addr);
+      mapped_ = true;
+      open_ = true;
+      return true;
+    }
+    size_ = 0;
+  } else {
+    ::close(fd);
+  }
+#endif
+  // Запасной путь: читаем файл целиком в буфер.
+  std::ifstream in(filename, std::ios::binary);
+  if (!in.is_open())
+    return false;
+  buffer_.assign(std::istreambuf_iterator<char>(in),
+                 std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  open_ = true;
+  return true;
+}
+
+void MappedFile::Close() {
+#if defined(MAPPED_FILE_HAS_MMAP)
+  if (mapped_)
+    ::munmap(const_cast<char *>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  open_ = false;
+  mapped_ = false;
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+}
+
+bool MappedFile::IsOpen() const { return open_; }
+
+std::string_view MappedFile::Data() const {
+  return std::string_view(data_, size_);
+}
@@ -0,0 +1,52 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>Файл, отображенный в память только для чтения.</summary>
+/// <remarks>На POSIX-системах используется mmap с подсказкой
+/// последовательного чтения; на остальных платформах файл целиком читается в
+/// буфер. Содержимое доступно как std::string_view и остается действительным,
+/// пока объект существует и не вызван Close.</remarks>
+class MappedFile {
+public:
+  /// <summary>Конструктор по умолчанию. Файл не открыт.</summary>
+  MappedFile();
+
+  /// <summary>Деструктор. Снимает отображение.</summary>
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /// <summary>Открывает файл и отображает его в память.</summary>
+  /// <param name="filename">Имя файла.</param>
+  /// <returns>true, если файл успешно открыт.</returns>
+  bool Open(const std::string &filename);
+
+  /// <summary>Снимает отображение и закрывает файл.</summary>
+  void Close();
+
+  /// <summary>Проверяет, открыт ли файл.</summary>
+  /// <returns>true, если файл открыт.</returns>
+  bool IsOpen() const;
+
+  /// <summary>Возвращает содержимое файла.</summary>
+  /// <returns>Представление всего файла (пустое, если файл пуст или не
+  /// открыт).</returns>
+  std::string_view Data() const;
+
+private:
+  const char *data_;
+  std::size_t size_;
+  bool open_;
+  bool mapped_;
+  /// <summary>Буфер для платформ без mmap и для случаев, когда отображение
+  /// невозможно (например, каналы).</summary>
+  std::vector<char> buffer_;
+};
+
+#endif // MAPPED_FILE_H_
@@ -0,0 +1,149 @@
+#include "metrics.h"
+
+#if defined(ENABLE_METRICS)
+
+#include "output_sink.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr int kCounterCount = static_cast<int>(MetricCounter::kCount);
+constexpr int kPhaseCount = static_cast<int>(MetricPhase::kCount);
+
+const char *const kCounterNames[kCounterCount] = {
+    "lines_parsed", "tokens",  "set_operations",
+    "container_growths", "lookups", "probes"};
+
+const char *const kPhaseNames[kPhaseCount] = {
+    "read_data",        "analyze",          "save_results",
+    "competition_read", "competition_rank", "competition_output",
+    "save_snapshot",    "load_snapshot",    "queries"};
+
+/// Сумма метрик по потокам.
+struct MetricsTotals {
+  std::uint64_t counters[kCounterCount] = {};
+  std::uint64_t max_probe_length = 0;
+  std::uint64_t phase_calls[kPhaseCount] = {};
+  std::uint64_t phase_ns[kPhaseCount] = {};
+
+  void Add(const MetricsThreadState &state) {
+    for (int c = 0; c < kCounterCount; ++c)
+      counters[c] += state.counters[c].load(std::memory_order_relaxed);
+    max_probe_length =
+        std::max<std::uint64_t>(max_probe_length, state.max_probe_length.load(
+                                                      std::memory_order_relaxed));
+    for (int p = 0; p < kPhaseCount; ++p) {
+      phase_calls[p] += state.phase_calls[p].load(std::memory_order_relaxed);
+      phase_ns[p] += state.phase_ns[p].load(std::memory_order_relaxed);
+    }
+  }
+};
+
+/// Живые потоки и итог завершившихся.
+struct MetricsRegistry {
+  std::mutex mutex;
+  std::vector<MetricsThreadState *> threads;
+  MetricsTotals retired;
+};
+
+MetricsRegistry &Registry() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+void Clear(MetricsThreadState &state) {
+  for (auto &counter : state.counters)
+    counter.store(0, std::memory_order_relaxed);
+  state.max_probe_length.store(0, std::memory_order_relaxed);
+  for (int p = 0; p < kPhaseCount; ++p) {
+    state.phase_calls[p].store(0, std::memory_order_relaxed);
+    state.phase_ns[p].store(0, std::memory_order_relaxed);
+  }
+}
+
+} // namespace
+
+MetricsThreadState::MetricsThreadState() {
+  Clear(*this);
+  MetricsRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.threads.push_back(this);
+}
+
+MetricsThreadState::~MetricsThreadState() {
+  MetricsRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.retired.Add(*this);
+  registry.threads.erase(
+      std::find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+void ResetMetrics() {
+  MetricsRegistry &registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.retired = MetricsTotals();
+  for (MetricsThreadState *state : registry.threads)
+    Clear(*state);
+}
+
+bool WriteMetricsJson(const std::string &filename) {
+  MetricsTotals totals;
+  {
+    MetricsRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    totals = registry.retired;
+    for (const MetricsThreadState *state : registry.threads)
+      totals.Add(*state);
+  }
+
+  OutputSink out;
+  if (!out.AddFile(filename))
+    return false;
+  out.Write("{\n  \"phases\": {\n");
+  for (int p = 0; p < kPhaseCount; ++p) {
+    out.Write("    \"")
+        .Write(kPhaseNames[p])
+        .Write("\": {\"calls\": ")
+        .Write(totals.phase_calls[p])
+        .Write(", \"total_ns\": ")
+        .Write(totals.phase_ns[p])
+        .Write(p + 1 < kPhaseCount ? "},\n" : "}\n");
+  }
+  out.Write("  },\n  \"counters\": {\n");
+  for (int c = 0; c < kCounterCount; ++c) {
+    out.Write("    \"")
+        .Write(kCounterNames[c])
+        .Write("\": ")
+        .Write(totals.counters[c])
+        .Write(",\n");
+  }
+  std::uint64_t lookups =
+      totals.counters[static_cast<int>(MetricCounter::kLookups)];
+  std::uint64_t probes =
+      totals.counters[static_cast<int>(MetricCounter::kProbes)];
+  char mean[32];
+  int length = std::snprintf(
+      mean, sizeof(mean), "%.3f",
+      lookups == 0 ? 0.0
+                   : static_cast<double>(probes) / static_cast<double>(lookups));
+  out.Write("    \"max_probe_length\": ")
+      .Write(totals.max_probe_length)
+      .Write(",\n    \"mean_probe_length\": ")
+      .Write(std::string_view(mean, static_cast<std::size_t>(length)))
+      .Write("\n  }\n}\n");
+  out.Flush();
+  return out.Good();
+}
+
+#else
+
+void ResetMetrics() {}
+
+bool WriteMetricsJson(const std::string &) { return false; }
+
+#endif
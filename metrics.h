@@ -0,0 +1,154 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(ENABLE_METRICS)
+#include <atomic>
+#include <chrono>
+#endif
+
+/// <summary>Счетчики событий.</summary>
+enum class MetricCounter {
+  /// <summary>Разобранные строки входных файлов.</summary>
+  kLinesParsed,
+  /// <summary>Разобранные поля: названия книг, имена, числа.</summary>
+  kTokens,
+  /// <summary>Операции над множествами (объединение, пересечение, разность;
+  /// для диапазона — по одной на множество-операнд).</summary>
+  kSetOperations,
+  /// <summary>Перевыделения массивов и хеш-таблиц UnorderedSet и
+  /// Dictionary.</summary>
+  kContainerGrowths,
+  /// <summary>Поиски ключа в хеш-таблицах.</summary>
+  kLookups,
+  /// <summary>Просмотренные при этих поисках ячейки.</summary>
+  kProbes,
+  kCount
+};
+
+/// <summary>Замеряемые этапы работы.</summary>
+enum class MetricPhase {
+  kReadData,
+  kAnalyze,
+  kSaveResults,
+  kCompetitionRead,
+  kCompetitionRank,
+  kCompetitionOutput,
+  kSaveSnapshot,
+  kLoadSnapshot,
+  kQueries,
+  kCount
+};
+
+/// <summary>Проверяет, собрана ли программа со сбором метрик.</summary>
+/// <returns>true, если определен ENABLE_METRICS.</returns>
+constexpr bool MetricsEnabled() {
+#if defined(ENABLE_METRICS)
+  return true;
+#else
+  return false;
+#endif
+}
+
+/// <summary>Обнуляет все счетчики и таймеры.</summary>
+/// <remarks>Вызывается, когда другие потоки не обновляют метрики (например,
+/// между прогонами).</remarks>
+void ResetMetrics();
+
+/// <summary>Сохраняет метрики в файл в формате JSON.</summary>
+/// <param name="filename">Имя файла.</param>
+/// <returns>false, если метрики не собраны в программу или файл не
+/// удалось записать.</returns>
+bool WriteMetricsJson(const std::string &filename);
+
+#if defined(ENABLE_METRICS)
+
+/// <summary>Метрики одного потока.</summary>
+/// <remarks>Поток пишет только в свой экземпляр, поэтому обновление — это
+/// обычные load/store без блокировок и разделяемых кеш-линий; atomic нужен
+/// лишь для того, чтобы WriteMetricsJson мог читать их из другого потока.
+/// При завершении потока значения переносятся в общий итог.</remarks>
+struct MetricsThreadState {
+  std::atomic<std::uint64_t> counters[static_cast<int>(MetricCounter::kCount)];
+  std::atomic<std::uint64_t> max_probe_length;
+  std::atomic<std::uint64_t> phase_calls[static_cast<int>(MetricPhase::kCount)];
+  std::atomic<std::uint64_t> phase_ns[static_cast<int>(MetricPhase::kCount)];
+
+  MetricsThreadState();
+  ~MetricsThreadState();
+
+  MetricsThreadState(const MetricsThreadState &) = delete;
+  MetricsThreadState &operator=(const MetricsThreadState &) = delete;
+};
+
+inline thread_local MetricsThreadState metrics_thread_state;
+
+/// <summary>Прибавляет value к счетчику.</summary>
+inline void MetricsAdd(std::atomic<std::uint64_t> &slot, std::uint64_t value) {
+  slot.store(slot.load(std::memory_order_relaxed) + value,
+             std::memory_order_relaxed);
+}
+
+/// <summary>Учитывает один поиск в хеш-таблице.</summary>
+/// <param name="length">Число просмотренных ячеек.</param>
+inline void MetricsProbe(std::size_t length) {
+  MetricsThreadState &state = metrics_thread_state;
+  MetricsAdd(state.counters[static_cast<int>(MetricCounter::kLookups)], 1);
+  MetricsAdd(state.counters[static_cast<int>(MetricCounter::kProbes)], length);
+  if (length > state.max_probe_length.load(std::memory_order_relaxed))
+    state.max_probe_length.store(length, std::memory_order_relaxed);
+}
+
+/// <summary>Замеряет время от создания до уничтожения объекта по монотонным
+/// часам и добавляет его к этапу.</summary>
+class PhaseTimer {
+public:
+  explicit PhaseTimer(MetricPhase phase)
+      : phase_(static_cast<int>(phase)),
+        start_(std::chrono::steady_clock::now()) {}
+
+  ~PhaseTimer() {
+    std::chrono::nanoseconds elapsed =
+        std::chrono::steady_clock::now() - start_;
+    MetricsThreadState &state = metrics_thread_state;
+    MetricsAdd(state.phase_calls[phase_], 1);
+    MetricsAdd(state.phase_ns[phase_],
+               static_cast<std::uint64_t>(elapsed.count()));
+  }
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+  int phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#define METRICS_CONCAT_IMPL(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_IMPL(a, b)
+
+/// Прибавляет value к счетчику MetricCounter::counter.
+#define METRICS_ADD(counter, value)                                            \
+  MetricsAdd(metrics_thread_state                                              \
+                 .counters[static_cast<int>(MetricCounter::counter)],          \
+             static_cast<std::uint64_t>(value))
+/// Учитывает поиск в хеш-таблице длиной length ячеек.
+#define METRICS_PROBE(length) MetricsProbe(length)
+/// Замеряет этап MetricPhase::phase до конца текущего блока.
+#define METRICS_PHASE(phase)                                                   \
+  PhaseTimer METRICS_CONCAT(phase_timer_, __LINE__)(MetricPhase::phase)
+
+#else
+
+// Без ENABLE_METRICS инструментирование не оставляет в коде ничего:
+// аргументы макросов даже не вычисляются.
+#define METRICS_ADD(counter, value) ((void)0)
+#define METRICS_PROBE(length) ((void)0)
+#define METRICS_PHASE(phase) ((void)0)
+
+#endif
+
+#endif // METRICS_H_
@@ -0,0 +1,142 @@
+#include "output_sink.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OUTPUT_SINK_HAS_WRITEV 1
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+OutputSink::OutputSink()
+    : blocks_(), current_(0), used_(0), destinations_(), good_(true) {}
+
+OutputSink::~OutputSink() {
+  Flush();
+#if defined(OUTPUT_SINK_HAS_WRITEV)
+  for (const Destination &destination : destinations_) {
+    if (destination.owned)
+      ::close(destination.fd);
+  }
+#endif
+}
+
+bool OutputSink::AddFile(const std::string &filename) {
+  Destination destination{-1, false, false, nullptr};
+#if defined(OUTPUT_SINK_HAS_WRITEV)
+  destination.fd =
+      ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (destination.fd < 0)
+    return false;
+  destination.owned = true;
+#else
+  destination.file.reset(new std::ofstream(filename, std::ios::binary));
+  if (!destination.file->is_open())
+    return false;
+#endif
+  destinations_.push_back(std::move(destination));
+  return true;
+}
+
+void OutputSink::AddStdout() {
+  destinations_.push_back(Destination{1, false, true, nullptr});
+}
+
+OutputSink &OutputSink::Write(std::string_view text) {
+  while (!text.empty()) {
+    std::size_t space = Space();
+    std::size_t chunk = text.size() < space ? text.size() : space;
+    std::memcpy(blocks_[current_].get() + used_, text.data(), chunk);
+    used_ += chunk;
+    text.remove_prefix(chunk);
+  }
+  return *this;
+}
+
+OutputSink &OutputSink::Write(char c) {
+  Space();
+  blocks_[current_][used_++] = c;
+  return *this;
+}
+
+void OutputSink::Flush() {
+  if (current_ == 0 && used_ == 0)
+    return;
+  for (Destination &destination : destinations_)
+    WriteBlocks(destination);
+  current_ = 0;
+  used_ = 0;
+}
+
+bool OutputSink::Good() const { return good_; }
+
+std::size_t OutputSink::Space() {
+  if (blocks_.empty())
+    blocks_.emplace_back(new char[kBlockSize]);
+  if (used_ == kBlockSize) {
+    if (current_ + 1 == kMaxBlocks) {
+      Flush();
+    } else {
+      ++current_;
+      used_ = 0;
+      if (current_ == blocks_.size())
+        blocks_.emplace_back(new char[kBlockSize]);
+    }
+  }
+  return kBlockSize - used_;
+}
+
+void OutputSink::WriteBlocks(Destination &destination) {
+  if (destination.console) {
+    // Текст, выведенный через std::cout до этого момента, должен оказаться
+    // раньше нашего.
+    std::cout.flush();
+    std::fflush(stdout);
+  }
+#if defined(OUTPUT_SINK_HAS_WRITEV)
+  iovec parts[kMaxBlocks];
+  int count = 0;
+  for (std::size_t b = 0; b <= current_; ++b) {
+    std::size_t size = b == current_ ? used_ : kBlockSize;
+    if (size == 0)
+      continue;
+    parts[count].iov_base = blocks_[b].get();
+    parts[count].iov_len = size;
+    ++count;
+  }
+  iovec *next = parts;
+  while (count > 0) {
+    ssize_t written = ::writev(destination.fd, next, count);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      good_ = false;
+      return;
+    }
+    // Частичная запись: пропускаем отправленные части и продолжаем.
+    std::size_t left = static_cast<std::size_t>(written);
+    while (count > 0 && left >= next->iov_len) {
+      left -= next->iov_len;
+      ++next;
+      --count;
+    }
+    if (count > 0) {
+      next->iov_base = static_cast<char *>(next->iov_base) + left;
+      next->iov_len -= left;
+    }
+  }
+#else
+  std::ostream &out = destination.console ? std::cout : *destination.file;
+  for (std::size_t b = 0; b <= current_; ++b) {
+    std::size_t size = b == current_ ? used_ : kBlockSize;
+    out.write(blocks_[b].get(), static_cast<std::streamsize>(size));
+  }
+  out.flush();
+  if (!out)
+    good_ = false;
+#endif
+}
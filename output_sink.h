@@ -0,0 +1,107 @@
+#ifndef OUTPUT_SINK_H_
+#define OUTPUT_SINK_H_
+
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// <summary>Буферизованный вывод сразу в несколько получателей (консоль,
+/// файлы).</summary>
+/// <remarks>Текст форматируется один раз в переиспользуемый буфер из блоков
+/// по 64 КБ, числа — std::to_chars. При заполнении буфера (1 МБ) и в Flush
+/// все блоки отправляются каждому получателю одним вызовом writev на POSIX
+/// (на остальных платформах — записью в поток). Перед записью в консоль
+/// сбрасывается std::cout, так что вывод через поток и через OutputSink не
+/// перемешивается.</remarks>
+class OutputSink {
+public:
+  /// <summary>Конструктор по умолчанию. Получателей нет.</summary>
+  OutputSink();
+
+  /// <summary>Деструктор. Выполняет Flush и закрывает открытые
+  /// файлы.</summary>
+  ~OutputSink();
+
+  OutputSink(const OutputSink &) = delete;
+  OutputSink &operator=(const OutputSink &) = delete;
+
+  /// <summary>Добавляет получателя — файл (создается или
+  /// перезаписывается).</summary>
+  /// <param name="filename">Имя файла.</param>
+  /// <returns>true, если файл открыт для записи.</returns>
+  bool AddFile(const std::string &filename);
+
+  /// <summary>Добавляет получателя — стандартный вывод.</summary>
+  void AddStdout();
+
+  /// <summary>Добавляет текст.</summary>
+  /// <param name="text">Текст.</param>
+  /// <returns>Ссылка на текущий объект.</returns>
+  OutputSink &Write(std::string_view text);
+
+  /// <summary>Добавляет символ.</summary>
+  /// <param name="c">Символ.</param>
+  /// <returns>Ссылка на текущий объект.</returns>
+  OutputSink &Write(char c);
+
+  /// <summary>Добавляет целое число в десятичной записи.</summary>
+  /// <param name="value">Число.</param>
+  /// <returns>Ссылка на текущий объект.</returns>
+  template <typename Int>
+  typename std::enable_if<std::is_integral<Int>::value, OutputSink &>::type
+  Write(Int value);
+
+  /// <summary>Отправляет накопленный текст всем получателям.</summary>
+  void Flush();
+
+  /// <summary>Проверяет, что все записи прошли успешно.</summary>
+  /// <returns>false, если хотя бы одна запись завершилась ошибкой.</returns>
+  bool Good() const;
+
+private:
+  static constexpr std::size_t kBlockSize = 64 * 1024;
+  static constexpr std::size_t kMaxBlocks = 16;
+  /// <summary>Наибольшая длина десятичной записи 64-битного числа со
+  /// знаком.</summary>
+  static constexpr std::size_t kMaxIntChars = 21;
+
+  /// <summary>Получатель: дескриптор (POSIX) или поток.</summary>
+  struct Destination {
+    int fd;
+    bool owned;
+    bool console;
+    std::unique_ptr<std::ofstream> file;
+  };
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  /// <summary>Номер заполняемого блока.</summary>
+  std::size_t current_;
+  /// <summary>Заполнено байт в текущем блоке.</summary>
+  std::size_t used_;
+  std::vector<Destination> destinations_;
+  bool good_;
+
+  /// <summary>Возвращает свободное место в текущем блоке (не меньше одного
+  /// байта), при необходимости переходя к следующему блоку или выполняя
+  /// Flush. Все блоки, кроме текущего, заполнены целиком.</summary>
+  std::size_t Space();
+
+  /// <summary>Отправляет все блоки одному получателю.</summary>
+  void WriteBlocks(Destination &destination);
+};
+
+template <typename Int>
+typename std::enable_if<std::is_integral<Int>::value, OutputSink &>::type
+OutputSink::Write(Int value) {
+  char digits[kMaxIntChars];
+  char *end = std::to_chars(digits, digits + kMaxIntChars, value).ptr;
+  return Write(
+      std::string_view(digits, static_cast<std::size_t>(end - digits)));
+}
+
+#endif // OUTPUT_SINK_H_
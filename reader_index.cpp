@@ -0,0 +1,63 @@
+#include "reader_index.h"
+
+#include <algorithm>
+
+ReaderIndex::ReaderIndex() : postings_(), counts_() {}
+
+void ReaderIndex::Reset(std::size_t title_count) {
+  postings_.clear();
+  postings_.resize(title_count);
+  counts_.Reset(title_count);
+}
+
+void ReaderIndex::AddTitle() {
+  postings_.emplace_back();
+  counts_.AddTitle();
+}
+
+void ReaderIndex::AddReader(TitleSpan books) {
+  std::uint32_t reader = static_cast<std::uint32_t>(ReaderCount());
+  for (std::size_t i = 0; i < books.size; ++i)
+    postings_[books.data[i]].push_back(reader);
+  counts_.AddReader(books);
+}
+
+void ReaderIndex::RemoveReader(std::size_t reader, TitleSpan books,
+                               TitleSpan last_books) {
+  std::uint32_t removed = static_cast<std::uint32_t>(reader);
+  std::uint32_t last = static_cast<std::uint32_t>(ReaderCount() - 1);
+  for (std::size_t i = 0; i < books.size; ++i) {
+    std::vector<std::uint32_t> &posting = postings_[books.data[i]];
+    posting.erase(std::lower_bound(posting.begin(), posting.end(), removed));
+  }
+  counts_.RemoveReader(books);
+  if (removed == last)
+    return;
+  // Последний читатель стоит в конце каждого своего списка: снимаем его
+  // оттуда и вставляем под новым номером, сохраняя порядок.
+  for (std::size_t i = 0; i < last_books.size; ++i) {
+    std::vector<std::uint32_t> &posting = postings_[last_books.data[i]];
+    posting.pop_back();
+    posting.insert(std::lower_bound(posting.begin(), posting.end(), removed),
+                   removed);
+  }
+}
+
+std::size_t ReaderIndex::TitleCount() const { return postings_.size(); }
+
+std::size_t ReaderIndex::ReaderCount() const { return counts_.ReaderCount(); }
+
+ReaderSpan ReaderIndex::ReadersOf(StringId title) const {
+  const std::vector<std::uint32_t> &posting = postings_[title];
+  return ReaderSpan{posting.data(), posting.size()};
+}
+
+bool ReaderIndex::HasRead(std::size_t reader, StringId title) const {
+  const std::vector<std::uint32_t> &posting = postings_[title];
+  return std::binary_search(posting.begin(), posting.end(),
+                            static_cast<std::uint32_t>(reader));
+}
+
+TitleSpan ReaderIndex::ReadByAtLeast(std::size_t count) const {
+  return counts_.ReadByAtLeast(count);
+}
@@ -0,0 +1,87 @@
+#ifndef READER_INDEX_H_
+#define READER_INDEX_H_
+
+#include "string_pool.h"
+#include "title_count_index.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>Отрезок номеров читателей без копирования.</summary>
+/// <remarks>Действителен до следующего изменения источника.</remarks>
+struct ReaderSpan {
+  const std::uint32_t *data;
+  std::size_t size;
+};
+
+/// <summary>Обратный индекс: для каждой книги — номера прочитавших ее
+/// читателей.</summary>
+/// <remarks>Списки читателей (posting lists) хранятся отсортированными,
+/// поэтому «читал ли читатель книгу» — двоичный поиск, а новый читатель
+/// (всегда с наибольшим номером) дописывается в конец списков своих книг.
+/// Вместе со списками ведется TitleCountIndex: книги, прочитанные не меньше
+/// чем k читателями, — готовый отрезок за O(1).
+///
+/// Номера читателей совпадают с BookAnalyzer: при удалении читателя его
+/// номер получает последний читатель. Последний читатель стоит в конце
+/// каждого своего списка, поэтому перенумерация — удаление с конца и вставка
+/// на место. Добавление читателя стоит O(число его книг), удаление — сдвиги
+/// в списках книг удаляемого и последнего читателей.</remarks>
+class ReaderIndex {
+public:
+  /// <summary>Конструктор по умолчанию. Нет ни книг, ни читателей.</summary>
+  ReaderIndex();
+
+  /// <summary>Сбрасывает индекс: title_count книг без читателей.</summary>
+  /// <param name="title_count">Количество книг (номера
+  /// 0..title_count-1).</param>
+  void Reset(std::size_t title_count);
+
+  /// <summary>Регистрирует новую книгу с номером TitleCount().</summary>
+  void AddTitle();
+
+  /// <summary>Добавляет читателя с номером ReaderCount().</summary>
+  /// <param name="books">Книги читателя без повторов (номера меньше
+  /// TitleCount()).</param>
+  void AddReader(TitleSpan books);
+
+  /// <summary>Удаляет читателя; его номер получает последний
+  /// читатель.</summary>
+  /// <param name="reader">Номер удаляемого читателя.</param>
+  /// <param name="books">Книги удаляемого читателя.</param>
+  /// <param name="last_books">Книги последнего читателя (те же, что books,
+  /// если удаляется последний).</param>
+  void RemoveReader(std::size_t reader, TitleSpan books, TitleSpan last_books);
+
+  /// <summary>Возвращает количество книг.</summary>
+  std::size_t TitleCount() const;
+
+  /// <summary>Возвращает количество читателей.</summary>
+  std::size_t ReaderCount() const;
+
+  /// <summary>Возвращает читателей книги по возрастанию номеров.</summary>
+  /// <param name="title">Номер книги.</param>
+  /// <returns>Отрезок внутреннего массива, до следующего изменения.</returns>
+  ReaderSpan ReadersOf(StringId title) const;
+
+  /// <summary>Проверяет, читал ли читатель книгу.</summary>
+  /// <param name="reader">Номер читателя.</param>
+  /// <param name="title">Номер книги.</param>
+  /// <returns>true, если читал; O(log числа читателей книги).</returns>
+  bool HasRead(std::size_t reader, StringId title) const;
+
+  /// <summary>Книги, прочитанные не меньше чем count читателями.</summary>
+  /// <param name="count">Наименьшее число читателей.</param>
+  /// <returns>Отрезок по убыванию числа читателей, до следующего
+  /// изменения.</returns>
+  TitleSpan ReadByAtLeast(std::size_t count) const;
+
+private:
+  /// <summary>Списки читателей каждой книги по возрастанию.</summary>
+  std::vector<std::vector<std::uint32_t>> postings_;
+  /// <summary>Число читателей каждой книги и порядок книг по нему.</summary>
+  TitleCountIndex counts_;
+};
+
+#endif // READER_INDEX_H_
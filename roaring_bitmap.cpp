@@ -0,0 +1,535 @@
+#include "roaring_bitmap.h"
+
+#include "bit_ops.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+using Kind = RoaringContainer::Kind;
+
+constexpr std::size_t kMaxArraySize = RoaringContainer::kMaxArraySize;
+constexpr std::size_t kBitmapWords = RoaringContainer::kBitmapWords;
+constexpr std::size_t kBitmapBytes = kBitmapWords * sizeof(std::uint64_t);
+
+/// Массив, который короче другого во столько раз, пересекается с ним
+/// двоичным поиском, а не слиянием.
+constexpr std::size_t kGallopRatio = 32;
+
+std::uint32_t CountBits(const std::vector<std::uint64_t> &words) {
+  std::uint32_t count = 0;
+  for (std::uint64_t word : words)
+    count += PopCount(word);
+  return count;
+}
+
+bool TestBit(const RoaringContainer &container, std::uint16_t low) {
+  return (container.words[low >> 6] >> (low & 63)) & 1;
+}
+
+/// Устанавливает биты отрезка [start, end].
+void SetRange(std::vector<std::uint64_t> &words, std::uint32_t start,
+              std::uint32_t end) {
+  std::uint32_t first = start >> 6;
+  std::uint32_t last = end >> 6;
+  std::uint64_t first_mask = ~std::uint64_t{0} << (start & 63);
+  std::uint64_t last_mask = ~std::uint64_t{0} >> (63 - (end & 63));
+  if (first == last) {
+    words[first] |= first_mask & last_mask;
+    return;
+  }
+  words[first] |= first_mask;
+  for (std::uint32_t w = first + 1; w < last; ++w)
+    words[w] = ~std::uint64_t{0};
+  words[last] |= last_mask;
+}
+
+void ToBitmap(RoaringContainer &container) {
+  std::vector<std::uint64_t> words(kBitmapWords, 0);
+  for (std::uint16_t low : container.values)
+    words[low >> 6] |= std::uint64_t{1} << (low & 63);
+  container.words.swap(words);
+  std::vector<std::uint16_t>().swap(container.values);
+  container.kind = Kind::kBitmap;
+}
+
+void ToArray(RoaringContainer &container) {
+  std::vector<std::uint16_t> values;
+  values.reserve(container.cardinality);
+  for (std::size_t w = 0; w < kBitmapWords; ++w) {
+    for (std::uint64_t word = container.words[w]; word != 0;
+         word &= word - 1) {
+      values.push_back(static_cast<std::uint16_t>(
+          w * 64 + CountTrailingZeros(word)));
+    }
+  }
+  container.values.swap(values);
+  std::vector<std::uint64_t>().swap(container.words);
+  container.kind = Kind::kArray;
+}
+
+/// Приводит массив или карту к представлению по мощности.
+void Normalize(RoaringContainer &container) {
+  if (container.kind == Kind::kBitmap &&
+      container.cardinality <= kMaxArraySize)
+    ToArray(container);
+  else if (container.kind == Kind::kArray &&
+           container.cardinality > kMaxArraySize)
+    ToBitmap(container);
+}
+
+/// Разворачивает список отрезков в массив или карту.
+void ExpandRuns(RoaringContainer &container) {
+  if (container.kind != Kind::kRun)
+    return;
+  std::vector<std::uint16_t> runs;
+  runs.swap(container.values);
+  if (container.cardinality > kMaxArraySize) {
+    container.words.assign(kBitmapWords, 0);
+    for (std::size_t r = 0; r < runs.size(); r += 2)
+      SetRange(container.words, runs[r], runs[r] + runs[r + 1]);
+    container.kind = Kind::kBitmap;
+  } else {
+    container.values.reserve(container.cardinality);
+    for (std::size_t r = 0; r < runs.size(); r += 2) {
+      std::uint32_t end = std::uint32_t{runs[r]} + runs[r + 1];
+      for (std::uint32_t low = runs[r]; low <= end; ++low)
+        container.values.push_back(static_cast<std::uint16_t>(low));
+    }
+    container.kind = Kind::kArray;
+  }
+}
+
+/// Возвращает контейнер без отрезков: сам container или его развернутую
+/// копию в temp.
+const RoaringContainer &Expanded(const RoaringContainer &container,
+                                 RoaringContainer &temp) {
+  if (container.kind != Kind::kRun)
+    return container;
+  temp = container;
+  ExpandRuns(temp);
+  return temp;
+}
+
+/// Пересекает отсортированные массивы на месте: в a остаются общие номера.
+void IntersectArrays(std::vector<std::uint16_t> &a,
+                     const std::vector<std::uint16_t> &b) {
+  std::size_t out = 0;
+  if (a.size() * kGallopRatio < b.size()) {
+    for (std::uint16_t low : a) {
+      if (std::binary_search(b.begin(), b.end(), low))
+        a[out++] = low;
+    }
+  } else if (b.size() * kGallopRatio < a.size()) {
+    // Номера b ищутся в еще не просмотренной части a; запись идет не
+    // дальше уже просмотренной.
+    auto from = a.begin();
+    for (std::uint16_t low : b) {
+      from = std::lower_bound(from, a.end(), low);
+      if (from == a.end())
+        break;
+      if (*from == low)
+        a[out++] = low;
+    }
+  } else {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+      if (a[i] < b[j]) {
+        ++i;
+      } else if (b[j] < a[i]) {
+        ++j;
+      } else {
+        a[out++] = a[i];
+        ++i;
+        ++j;
+      }
+    }
+  }
+  a.resize(out);
+}
+
+/// Удаляет из отсортированного массива a номера массива b на месте.
+void SubtractArrays(std::vector<std::uint16_t> &a,
+                    const std::vector<std::uint16_t> &b) {
+  std::size_t out = 0;
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    while (j < b.size() && b[j] < a[i])
+      ++j;
+    if (j == b.size() || b[j] != a[i])
+      a[out++] = a[i];
+  }
+  a.resize(out);
+}
+
+void AndContainer(RoaringContainer &a, const RoaringContainer &other) {
+  ExpandRuns(a);
+  RoaringContainer temp;
+  const RoaringContainer &b = Expanded(other, temp);
+  if (a.kind == Kind::kArray && b.kind == Kind::kArray) {
+    IntersectArrays(a.values, b.values);
+    a.cardinality = static_cast<std::uint32_t>(a.values.size());
+  } else if (a.kind == Kind::kArray) {
+    std::size_t out = 0;
+    for (std::uint16_t low : a.values) {
+      if (TestBit(b, low))
+        a.values[out++] = low;
+    }
+    a.values.resize(out);
+    a.cardinality = static_cast<std::uint32_t>(out);
+  } else if (b.kind == Kind::kArray) {
+    std::vector<std::uint16_t> values;
+    values.reserve(b.values.size());
+    for (std::uint16_t low : b.values) {
+      if (TestBit(a, low))
+        values.push_back(low);
+    }
+    a.values.swap(values);
+    std::vector<std::uint64_t>().swap(a.words);
+    a.kind = Kind::kArray;
+    a.cardinality = static_cast<std::uint32_t>(a.values.size());
+  } else {
+    for (std::size_t w = 0; w < kBitmapWords; ++w)
+      a.words[w] &= b.words[w];
+    a.cardinality = CountBits(a.words);
+    Normalize(a);
+  }
+}
+
+void OrContainer(RoaringContainer &a, const RoaringContainer &other) {
+  ExpandRuns(a);
+  RoaringContainer temp;
+  const RoaringContainer &b = Expanded(other, temp);
+  if (a.kind == Kind::kArray && b.kind == Kind::kArray) {
+    std::vector<std::uint16_t> values;
+    values.reserve(a.values.size() + b.values.size());
+    std::set_union(a.values.begin(), a.values.end(), b.values.begin(),
+                   b.values.end(), std::back_inserter(values));
+    a.values.swap(values);
+    a.cardinality = static_cast<std::uint32_t>(a.values.size());
+    Normalize(a);
+  } else if (a.kind == Kind::kArray) {
+    std::vector<std::uint64_t> words = b.words;
+    for (std::uint16_t low : a.values)
+      words[low >> 6] |= std::uint64_t{1} << (low & 63);
+    a.words.swap(words);
+    std::vector<std::uint16_t>().swap(a.values);
+    a.kind = Kind::kBitmap;
+    a.cardinality = CountBits(a.words);
+  } else if (b.kind == Kind::kArray) {
+    for (std::uint16_t low : b.values) {
+      std::uint64_t bit = std::uint64_t{1} << (low & 63);
+      a.cardinality += (a.words[low >> 6] & bit) == 0;
+      a.words[low >> 6] |= bit;
+    }
+  } else {
+    for (std::size_t w = 0; w < kBitmapWords; ++w)
+      a.words[w] |= b.words[w];
+    a.cardinality = CountBits(a.words);
+  }
+}
+
+void AndNotContainer(RoaringContainer &a, const RoaringContainer &other) {
+  ExpandRuns(a);
+  RoaringContainer temp;
+  const RoaringContainer &b = Expanded(other, temp);
+  if (a.kind == Kind::kArray && b.kind == Kind::kArray) {
+    SubtractArrays(a.values, b.values);
+    a.cardinality = static_cast<std::uint32_t>(a.values.size());
+  } else if (a.kind == Kind::kArray) {
+    std::size_t out = 0;
+    for (std::uint16_t low : a.values) {
+      if (!TestBit(b, low))
+        a.values[out++] = low;
+    }
+    a.values.resize(out);
+    a.cardinality = static_cast<std::uint32_t>(out);
+  } else if (b.kind == Kind::kArray) {
+    for (std::uint16_t low : b.values) {
+      std::uint64_t bit = std::uint64_t{1} << (low & 63);
+      a.cardinality -= (a.words[low >> 6] & bit) != 0;
+      a.words[low >> 6] &= ~bit;
+    }
+    Normalize(a);
+  } else {
+    for (std::size_t w = 0; w < kBitmapWords; ++w)
+      a.words[w] &= ~b.words[w];
+    a.cardinality = CountBits(a.words);
+    Normalize(a);
+  }
+}
+
+/// Количество отрезков подряд идущих номеров в массиве или карте.
+std::size_t CountRuns(const RoaringContainer &container) {
+  std::size_t runs = 0;
+  if (container.kind == Kind::kArray) {
+    for (std::size_t i = 0; i < container.values.size(); ++i) {
+      if (i == 0 || container.values[i] != container.values[i - 1] + 1)
+        ++runs;
+    }
+    return runs;
+  }
+  // Отрезок начинается с установленного бита, перед которым бит сброшен.
+  std::uint64_t carry = 0;
+  for (std::uint64_t word : container.words) {
+    runs += PopCount(word & ~((word << 1) | carry));
+    carry = word >> 63;
+  }
+  return runs;
+}
+
+/// Переводит массив или карту в список отрезков.
+void ToRuns(RoaringContainer &container) {
+  std::vector<std::uint16_t> runs;
+  auto append = [&runs](std::uint16_t low) {
+    if (!runs.empty() &&
+        std::uint32_t{runs[runs.size() - 2]} + runs.back() + 1 == low) {
+      ++runs.back();
+    } else {
+      runs.push_back(low);
+      runs.push_back(0);
+    }
+  };
+  if (container.kind == Kind::kArray) {
+    for (std::uint16_t low : container.values)
+      append(low);
+  } else {
+    for (std::size_t w = 0; w < kBitmapWords; ++w) {
+      for (std::uint64_t word = container.words[w]; word != 0;
+           word &= word - 1) {
+        append(static_cast<std::uint16_t>(
+            w * 64 + CountTrailingZeros(word)));
+      }
+    }
+  }
+  runs.shrink_to_fit();
+  container.values.swap(runs);
+  std::vector<std::uint64_t>().swap(container.words);
+  container.kind = Kind::kRun;
+}
+
+} // namespace
+
+RoaringBitmap::RoaringBitmap() : keys_(), containers_() {}
+
+RoaringBitmap RoaringBitmap::FromSorted(const std::uint32_t *values,
+                                        std::size_t count) {
+  RoaringBitmap result;
+  std::size_t i = 0;
+  while (i < count) {
+    std::uint16_t key = static_cast<std::uint16_t>(values[i] >> 16);
+    std::size_t end = i;
+    while (end < count && (values[end] >> 16) == key)
+      ++end;
+    RoaringContainer container;
+    container.cardinality = static_cast<std::uint32_t>(end - i);
+    if (end - i > kMaxArraySize) {
+      container.kind = Kind::kBitmap;
+      container.words.assign(kBitmapWords, 0);
+      for (; i < end; ++i) {
+        std::uint16_t low = static_cast<std::uint16_t>(values[i]);
+        container.words[low >> 6] |= std::uint64_t{1} << (low & 63);
+      }
+    } else {
+      container.values.reserve(end - i);
+      for (; i < end; ++i)
+        container.values.push_back(static_cast<std::uint16_t>(values[i]));
+    }
+    result.keys_.push_back(key);
+    result.containers_.push_back(std::move(container));
+  }
+  return result;
+}
+
+void RoaringBitmap::Add(std::uint32_t value) {
+  std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+  std::uint16_t low = static_cast<std::uint16_t>(value);
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  std::size_t index = static_cast<std::size_t>(it - keys_.begin());
+  if (it == keys_.end() || *it != key) {
+    keys_.insert(it, key);
+    containers_.insert(containers_.begin() + static_cast<std::ptrdiff_t>(index),
+                       RoaringContainer());
+  }
+  RoaringContainer &container = containers_[index];
+  ExpandRuns(container);
+  if (container.kind == Kind::kBitmap) {
+    std::uint64_t bit = std::uint64_t{1} << (low & 63);
+    container.cardinality += (container.words[low >> 6] & bit) == 0;
+    container.words[low >> 6] |= bit;
+    return;
+  }
+  auto pos =
+      std::lower_bound(container.values.begin(), container.values.end(), low);
+  if (pos != container.values.end() && *pos == low)
+    return;
+  container.values.insert(pos, low);
+  ++container.cardinality;
+  Normalize(container);
+}
+
+bool RoaringBitmap::Contains(std::uint32_t value) const {
+  std::size_t index = FindKey(static_cast<std::uint16_t>(value >> 16));
+  if (index == keys_.size())
+    return false;
+  const RoaringContainer &container = containers_[index];
+  std::uint16_t low = static_cast<std::uint16_t>(value);
+  switch (container.kind) {
+  case Kind::kArray:
+    return std::binary_search(container.values.begin(),
+                              container.values.end(), low);
+  case Kind::kBitmap:
+    return TestBit(container, low);
+  case Kind::kRun: {
+    // Последний отрезок, начинающийся не позже low.
+    std::size_t lo = 0;
+    std::size_t hi = container.values.size() / 2;
+    while (lo < hi) {
+      std::size_t mid = (lo + hi) / 2;
+      if (container.values[2 * mid] <= low)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo == 0)
+      return false;
+    std::uint32_t start = container.values[2 * (lo - 1)];
+    return low <= start + container.values[2 * (lo - 1) + 1];
+  }
+  }
+  return false;
+}
+
+std::size_t RoaringBitmap::Count() const {
+  std::size_t count = 0;
+  for (const RoaringContainer &container : containers_)
+    count += container.cardinality;
+  return count;
+}
+
+bool RoaringBitmap::None() const { return keys_.empty(); }
+
+void RoaringBitmap::Clear() {
+  keys_.clear();
+  containers_.clear();
+}
+
+void RoaringBitmap::AndWith(const RoaringBitmap &other) {
+  METRICS_ADD(kSetOperations, 1);
+  if (&other == this)
+    return;
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    while (j < other.keys_.size() && other.keys_[j] < keys_[i])
+      ++j;
+    if (j < other.keys_.size() && other.keys_[j] == keys_[i])
+      AndContainer(containers_[i], other.containers_[j]);
+    else
+      containers_[i].cardinality = 0;
+  }
+  RemoveEmpty();
+}
+
+void RoaringBitmap::OrWith(const RoaringBitmap &other) {
+  METRICS_ADD(kSetOperations, 1);
+  if (&other == this)
+    return;
+  std::vector<std::uint16_t> keys;
+  std::vector<RoaringContainer> containers;
+  keys.reserve(keys_.size() + other.keys_.size());
+  containers.reserve(keys_.size() + other.keys_.size());
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < keys_.size() || j < other.keys_.size()) {
+    if (j == other.keys_.size() ||
+        (i < keys_.size() && keys_[i] < other.keys_[j])) {
+      keys.push_back(keys_[i]);
+      containers.push_back(std::move(containers_[i++]));
+    } else if (i == keys_.size() || other.keys_[j] < keys_[i]) {
+      keys.push_back(other.keys_[j]);
+      containers.push_back(other.containers_[j++]);
+    } else {
+      OrContainer(containers_[i], other.containers_[j++]);
+      keys.push_back(keys_[i]);
+      containers.push_back(std::move(containers_[i++]));
+    }
+  }
+  keys_.swap(keys);
+  containers_.swap(containers);
+}
+
+void RoaringBitmap::AndNotWith(const RoaringBitmap &other) {
+  METRICS_ADD(kSetOperations, 1);
+  if (&other == this) {
+    Clear();
+    return;
+  }
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    while (j < other.keys_.size() && other.keys_[j] < keys_[i])
+      ++j;
+    if (j < other.keys_.size() && other.keys_[j] == keys_[i])
+      AndNotContainer(containers_[i], other.containers_[j]);
+  }
+  RemoveEmpty();
+}
+
+void RoaringBitmap::RunOptimize() {
+  for (RoaringContainer &container : containers_) {
+    ExpandRuns(container);
+    std::size_t run_bytes = CountRuns(container) * 2 * sizeof(std::uint16_t);
+    std::size_t plain_bytes = container.kind == Kind::kArray
+                                  ? container.values.size() *
+                                        sizeof(std::uint16_t)
+                                  : kBitmapBytes;
+    if (run_bytes < plain_bytes) {
+      ToRuns(container);
+    } else {
+      container.values.shrink_to_fit();
+    }
+  }
+}
+
+std::size_t RoaringBitmap::MemoryBytes() const {
+  std::size_t bytes = sizeof(*this) +
+                      keys_.capacity() * sizeof(std::uint16_t) +
+                      containers_.capacity() * sizeof(RoaringContainer);
+  for (const RoaringContainer &container : containers_) {
+    bytes += container.values.capacity() * sizeof(std::uint16_t) +
+             container.words.capacity() * sizeof(std::uint64_t);
+  }
+  return bytes;
+}
+
+std::vector<std::uint32_t> RoaringBitmap::ToIndices() const {
+  std::vector<std::uint32_t> indices;
+  indices.reserve(Count());
+  ForEach([&indices](std::uint32_t value) { indices.push_back(value); });
+  return indices;
+}
+
+std::size_t RoaringBitmap::FindKey(std::uint16_t key) const {
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end() || *it != key)
+    return keys_.size();
+  return static_cast<std::size_t>(it - keys_.begin());
+}
+
+void RoaringBitmap::RemoveEmpty() {
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    if (containers_[i].cardinality == 0)
+      continue;
+    if (kept != i) {
+      keys_[kept] = keys_[i];
+      containers_[kept] = std::move(containers_[i]);
+    }
+    ++kept;
+  }
+  keys_.resize(kept);
+  containers_.resize(kept);
+}
@@ -0,0 +1,157 @@
+#ifndef ROARING_BITMAP_H_
+#define ROARING_BITMAP_H_
+
+#include "bit_ops.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>Контейнер RoaringBitmap: младшие 16 бит номеров одного блока из
+/// 65536.</summary>
+/// <remarks>Внутренняя структура RoaringBitmap; вынесена из класса, чтобы
+/// ForEach мог обходить контейнеры в заголовке.</remarks>
+struct RoaringContainer {
+  enum class Kind : std::uint8_t {
+    /// <summary>values — отсортированные номера (не больше
+    /// kMaxArraySize).</summary>
+    kArray,
+    /// <summary>words — 1024 слова, по биту на номер.</summary>
+    kBitmap,
+    /// <summary>values — пары (начало, длина - 1) непересекающихся
+    /// отрезков по возрастанию.</summary>
+    kRun,
+  };
+
+  /// <summary>Наибольший размер массива; больше — битовая карта.</summary>
+  static constexpr std::size_t kMaxArraySize = 4096;
+  /// <summary>Количество слов битовой карты.</summary>
+  static constexpr std::size_t kBitmapWords = 1024;
+
+  Kind kind = Kind::kArray;
+  std::uint32_t cardinality = 0;
+  std::vector<std::uint16_t> values;
+  std::vector<std::uint64_t> words;
+};
+
+/// <summary>Сжатое битовое множество 32-битных номеров в стиле
+/// Roaring.</summary>
+/// <remarks>Номера делятся на блоки по 65536 по старшим 16 битам; для
+/// каждого непустого блока хранится свой контейнер: отсортированный массив
+/// (до 4096 номеров), битовая карта (8 КБ) или список отрезков. Поэтому
+/// разреженное множество над огромным диапазоном занимает память
+/// пропорционально числу номеров, а плотное — не больше битовой карты.
+///
+/// AndWith/OrWith/AndNotWith сливают списки блоков и обрабатывают только
+/// совпавшие блоки: массив с массивом — слиянием (или двоичным поиском при
+/// большой разнице размеров), массив с картой — проверкой битов, карта с
+/// картой — пословно. После операции контейнер переходит в массив или карту
+/// по мощности. Отрезки появляются только после RunOptimize и перед
+/// операциями разворачиваются в массив или карту.</remarks>
+class RoaringBitmap {
+public:
+  /// <summary>Конструктор по умолчанию. Создает пустое множество.</summary>
+  RoaringBitmap();
+
+  /// <summary>Строит множество из возрастающей последовательности.</summary>
+  /// <param name="values">Номера строго по возрастанию.</param>
+  /// <param name="count">Количество номеров.</param>
+  /// <returns>Множество (без RunOptimize).</returns>
+  static RoaringBitmap FromSorted(const std::uint32_t *values,
+                                  std::size_t count);
+
+  /// <summary>Добавляет номер.</summary>
+  /// <param name="value">Номер.</param>
+  void Add(std::uint32_t value);
+
+  /// <summary>Проверяет наличие номера.</summary>
+  /// <param name="value">Номер.</param>
+  /// <returns>true, если номер есть в множестве.</returns>
+  bool Contains(std::uint32_t value) const;
+
+  /// <summary>Возвращает количество номеров.</summary>
+  /// <returns>Мощность множества.</returns>
+  std::size_t Count() const;
+
+  /// <summary>Проверяет, пусто ли множество.</summary>
+  /// <returns>true, если номеров нет.</returns>
+  bool None() const;
+
+  /// <summary>Удаляет все номера.</summary>
+  void Clear();
+
+  /// <summary>Пересечение на месте: this &= other.</summary>
+  /// <param name="other">Множество.</param>
+  void AndWith(const RoaringBitmap &other);
+
+  /// <summary>Объединение на месте: this |= other.</summary>
+  /// <param name="other">Множество.</param>
+  void OrWith(const RoaringBitmap &other);
+
+  /// <summary>Разность на месте: this &= ~other.</summary>
+  /// <param name="other">Множество.</param>
+  void AndNotWith(const RoaringBitmap &other);
+
+  /// <summary>Выбирает для каждого блока самое компактное представление,
+  /// включая список отрезков.</summary>
+  /// <remarks>Имеет смысл для множеств, которые долго хранятся и редко
+  /// меняются (например, книги читателей).</remarks>
+  void RunOptimize();
+
+  /// <summary>Возвращает приблизительный объем памяти множества.</summary>
+  /// <returns>Байты объекта и всех контейнеров.</returns>
+  std::size_t MemoryBytes() const;
+
+  /// <summary>Возвращает номера по возрастанию.</summary>
+  /// <returns>Вектор номеров.</returns>
+  std::vector<std::uint32_t> ToIndices() const;
+
+  /// <summary>Вызывает visitor(номер) для каждого номера по
+  /// возрастанию.</summary>
+  /// <param name="visitor">Функция, принимающая std::uint32_t.</param>
+  template <typename Visitor> void ForEach(Visitor visitor) const;
+
+private:
+  /// <summary>Старшие 16 бит номеров блоков, по возрастанию.</summary>
+  std::vector<std::uint16_t> keys_;
+  /// <summary>Контейнеры блоков, параллельно keys_.</summary>
+  std::vector<RoaringContainer> containers_;
+
+  /// <summary>Индекс блока с ключом key или keys_.size().</summary>
+  std::size_t FindKey(std::uint16_t key) const;
+
+  /// <summary>Удаляет пустые контейнеры.</summary>
+  void RemoveEmpty();
+};
+
+template <typename Visitor> void RoaringBitmap::ForEach(Visitor visitor) const {
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    std::uint32_t high = static_cast<std::uint32_t>(keys_[i]) << 16;
+    const RoaringContainer &container = containers_[i];
+    switch (container.kind) {
+    case RoaringContainer::Kind::kArray:
+      for (std::uint16_t low : container.values)
+        visitor(high | low);
+      break;
+    case RoaringContainer::Kind::kBitmap:
+      for (std::size_t w = 0; w < RoaringContainer::kBitmapWords; ++w) {
+        for (std::uint64_t word = container.words[w]; word != 0;
+             word &= word - 1) {
+          visitor(high | static_cast<std::uint32_t>(
+                             w * 64 + CountTrailingZeros(word)));
+        }
+      }
+      break;
+    case RoaringContainer::Kind::kRun:
+      for (std::size_t r = 0; r < container.values.size(); r += 2) {
+        std::uint32_t start = container.values[r];
+        std::uint32_t end = start + container.values[r + 1];
+        for (std::uint32_t low = start; low <= end; ++low)
+          visitor(high | low);
+      }
+      break;
+    }
+  }
+}
+
+#endif // ROARING_BITMAP_H_
@@ -0,0 +1,282 @@
+#include "snapshot.h"
+
+#include "output_sink.h"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'L', 'A', 'B', '6', 'S', 'N', 'A', 'P'};
+constexpr std::size_t kSectionAlignment = 8;
+
+std::uint64_t AlignUp(std::uint64_t offset) {
+  return (offset + kSectionAlignment - 1) &
+         ~std::uint64_t{kSectionAlignment - 1};
+}
+
+/// Смещения секций от начала файла; вычисляются только из заголовка.
+struct SnapshotLayout {
+  std::uint64_t title_offsets;
+  std::uint64_t text;
+  std::uint64_t catalog;
+  std::uint64_t reader_offsets;
+  std::uint64_t members;
+  std::uint64_t categories;
+  std::uint64_t end;
+};
+
+SnapshotLayout ComputeLayout(const SnapshotHeader &header) {
+  SnapshotLayout layout;
+  layout.title_offsets = AlignUp(sizeof(SnapshotHeader));
+  layout.text = AlignUp(layout.title_offsets +
+                        (header.title_count + 1) * sizeof(std::uint64_t));
+  layout.catalog = AlignUp(layout.text + header.text_bytes);
+  layout.reader_offsets =
+      AlignUp(layout.catalog + header.catalog_count * sizeof(StringId));
+  layout.members = AlignUp(layout.reader_offsets +
+                           (header.reader_count + 1) * sizeof(std::uint64_t));
+  layout.categories =
+      AlignUp(layout.members + header.member_count * sizeof(StringId));
+  std::uint64_t category_total = 0;
+  if ((header.flags & kSnapshotHasResults) != 0) {
+    for (std::uint64_t count : header.category_counts)
+      category_total += count;
+  }
+  layout.end = AlignUp(layout.categories + category_total * sizeof(StringId));
+  return layout;
+}
+
+/// Проверяет, что смещения не убывают, начинаются с нуля и заканчиваются
+/// на total.
+bool OffsetsValid(const std::uint64_t *offsets, std::uint64_t count,
+                  std::uint64_t total) {
+  if (offsets[0] != 0 || offsets[count] != total)
+    return false;
+  for (std::uint64_t i = 0; i < count; ++i) {
+    if (offsets[i] > offsets[i + 1])
+      return false;
+  }
+  return true;
+}
+
+/// Счетчики заголовка не больше размера файла: иначе расчет секций может
+/// переполниться.
+bool CountsPlausible(const SnapshotHeader &header, std::uint64_t file_size) {
+  std::uint64_t limit = file_size / sizeof(StringId);
+  if (header.title_count > limit || header.text_bytes > file_size ||
+      header.catalog_count > limit || header.reader_count > limit ||
+      header.member_count > limit)
+    return false;
+  for (std::uint64_t count : header.category_counts) {
+    if (count > limit)
+      return false;
+  }
+  return true;
+}
+
+void WriteBytes(OutputSink &out, const void *data, std::size_t bytes) {
+  out.Write(std::string_view(static_cast<const char *>(data), bytes));
+}
+
+void WritePadding(OutputSink &out, std::uint64_t &position) {
+  static const char kZeros[kSectionAlignment] = {};
+  std::uint64_t aligned = AlignUp(position);
+  WriteBytes(out, kZeros, static_cast<std::size_t>(aligned - position));
+  position = aligned;
+}
+
+void WriteIds(OutputSink &out, TitleSpan books, std::uint64_t &position) {
+  WriteBytes(out, books.data, books.size * sizeof(StringId));
+  position += books.size * sizeof(StringId);
+}
+
+} // namespace
+
+BookSnapshot::BookSnapshot()
+    : file_(), header_(nullptr), title_offsets_(nullptr), text_(nullptr),
+      catalog_(nullptr), reader_offsets_(nullptr), members_(nullptr),
+      categories_{nullptr, nullptr, nullptr} {}
+
+bool BookSnapshot::Open(const std::string &filename, std::string &error) {
+  Close();
+  error.clear();
+  if (!file_.Open(filename)) {
+    error = "не удалось открыть файл " + filename;
+    return false;
+  }
+  std::string_view data = file_.Data();
+  const char *base = data.data();
+  if (data.size() < sizeof(SnapshotHeader) ||
+      reinterpret_cast<std::uintptr_t>(base) % alignof(SnapshotHeader) != 0) {
+    error = "файл не является снимком";
+    Close();
+    return false;
+  }
+  const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader *>(base);
+  if (std::memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+    error = "файл не является снимком";
+  } else if (header->version != kSnapshotVersion) {
+    error = "неподдерживаемая версия снимка " + std::to_string(header->version);
+  } else if (header->byte_order != kSnapshotByteOrder) {
+    error = "снимок записан на машине с другим порядком байтов";
+  } else if (header->file_size != data.size() ||
+             !CountsPlausible(*header, data.size()) ||
+             ComputeLayout(*header).end != data.size()) {
+    error = "размер снимка не совпадает с заголовком";
+  }
+  if (!error.empty()) {
+    Close();
+    return false;
+  }
+
+  SnapshotLayout layout = ComputeLayout(*header);
+  title_offsets_ =
+      reinterpret_cast<const std::uint64_t *>(base + layout.title_offsets);
+  reader_offsets_ =
+      reinterpret_cast<const std::uint64_t *>(base + layout.reader_offsets);
+  if (!OffsetsValid(title_offsets_, header->title_count, header->text_bytes) ||
+      !OffsetsValid(reader_offsets_, header->reader_count,
+                    header->member_count)) {
+    error = "повреждены смещения в снимке";
+    Close();
+    return false;
+  }
+  header_ = header;
+  text_ = base + layout.text;
+  catalog_ = reinterpret_cast<const StringId *>(base + layout.catalog);
+  members_ = reinterpret_cast<const StringId *>(base + layout.members);
+  const StringId *category =
+      reinterpret_cast<const StringId *>(base + layout.categories);
+  for (int i = 0; i < 3; ++i) {
+    categories_[i] = category;
+    if (HasResults())
+      category += header->category_counts[i];
+  }
+  return true;
+}
+
+void BookSnapshot::Close() {
+  file_.Close();
+  header_ = nullptr;
+  title_offsets_ = nullptr;
+  text_ = nullptr;
+  catalog_ = nullptr;
+  reader_offsets_ = nullptr;
+  members_ = nullptr;
+  for (const StringId *&category : categories_)
+    category = nullptr;
+}
+
+std::size_t BookSnapshot::TitleCount() const {
+  return header_ == nullptr ? 0 : header_->title_count;
+}
+
+std::string_view BookSnapshot::Title(StringId id) const {
+  return std::string_view(text_ + title_offsets_[id],
+                          title_offsets_[id + 1] - title_offsets_[id]);
+}
+
+TitleSpan BookSnapshot::Catalog() const {
+  return TitleSpan{catalog_, header_ == nullptr ? 0 : header_->catalog_count};
+}
+
+std::size_t BookSnapshot::ReaderCount() const {
+  return header_ == nullptr ? 0 : header_->reader_count;
+}
+
+TitleSpan BookSnapshot::ReaderBooks(std::size_t reader) const {
+  return TitleSpan{members_ + reader_offsets_[reader],
+                   reader_offsets_[reader + 1] - reader_offsets_[reader]};
+}
+
+bool BookSnapshot::HasResults() const {
+  return header_ != nullptr && (header_->flags & kSnapshotHasResults) != 0;
+}
+
+TitleSpan BookSnapshot::Category(int category) const {
+  if (!HasResults())
+    return TitleSpan{nullptr, 0};
+  return TitleSpan{categories_[category], header_->category_counts[category]};
+}
+
+SnapshotWriter::SnapshotWriter()
+    : titles_(), catalog_{nullptr, 0}, readers_(), has_results_(false),
+      categories_{{nullptr, 0}, {nullptr, 0}, {nullptr, 0}} {}
+
+void SnapshotWriter::AddTitle(std::string_view title) {
+  titles_.push_back(title);
+}
+
+void SnapshotWriter::SetCatalog(TitleSpan books) { catalog_ = books; }
+
+void SnapshotWriter::AddReader(TitleSpan books) { readers_.push_back(books); }
+
+void SnapshotWriter::SetResults(TitleSpan all, TitleSpan some,
+                                TitleSpan none) {
+  has_results_ = true;
+  categories_[0] = all;
+  categories_[1] = some;
+  categories_[2] = none;
+}
+
+bool SnapshotWriter::Save(const std::string &filename) const {
+  SnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+  header.version = kSnapshotVersion;
+  header.byte_order = kSnapshotByteOrder;
+  header.flags = has_results_ ? kSnapshotHasResults : 0;
+  header.title_count = titles_.size();
+  for (std::string_view title : titles_)
+    header.text_bytes += title.size();
+  header.catalog_count = catalog_.size;
+  header.reader_count = readers_.size();
+  for (const TitleSpan &reader : readers_)
+    header.member_count += reader.size;
+  for (int i = 0; i < 3; ++i)
+    header.category_counts[i] = has_results_ ? categories_[i].size : 0;
+  header.file_size = ComputeLayout(header).end;
+
+  OutputSink out;
+  if (!out.AddFile(filename))
+    return false;
+  std::uint64_t position = 0;
+  WriteBytes(out, &header, sizeof(header));
+  position += sizeof(header);
+  WritePadding(out, position);
+
+  std::uint64_t offset = 0;
+  WriteBytes(out, &offset, sizeof(offset));
+  for (std::string_view title : titles_) {
+    offset += title.size();
+    WriteBytes(out, &offset, sizeof(offset));
+  }
+  position += (titles_.size() + 1) * sizeof(std::uint64_t);
+  for (std::string_view title : titles_)
+    out.Write(title);
+  position += header.text_bytes;
+  WritePadding(out, position);
+
+  WriteIds(out, catalog_, position);
+  WritePadding(out, position);
+
+  offset = 0;
+  WriteBytes(out, &offset, sizeof(offset));
+  for (const TitleSpan &reader : readers_) {
+    offset += reader.size;
+    WriteBytes(out, &offset, sizeof(offset));
+  }
+  position += (readers_.size() + 1) * sizeof(std::uint64_t);
+  for (const TitleSpan &reader : readers_)
+    WriteIds(out, reader, position);
+  WritePadding(out, position);
+
+  if (has_results_) {
+    for (const TitleSpan &category : categories_)
+      WriteIds(out, category, position);
+    WritePadding(out, position);
+  }
+  out.Flush();
+  return out.Good() && position == header.file_size;
+}
@@ -0,0 +1,152 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "mapped_file.h"
+#include "string_pool.h"
+#include "title_count_index.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// <summary>Версия формата снимка; файлы другой версии не
+/// загружаются.</summary>
+constexpr std::uint32_t kSnapshotVersion = 1;
+
+/// <summary>Значение поля byte_order; при чтении на машине с другим порядком
+/// байтов оно не совпадает.</summary>
+constexpr std::uint32_t kSnapshotByteOrder = 0x01020304;
+
+/// <summary>Заголовок двоичного снимка BookAnalyzer.</summary>
+/// <remarks>Формат (все числа в порядке байтов записавшей машины, каждая
+/// секция выровнена на 8 байт):
+///   заголовок;
+///   смещения названий — uint64[title_count + 1] в секции текста;
+///   текст названий — char[text_bytes];
+///   каталог — StringId[catalog_count];
+///   смещения читателей — uint64[reader_count + 1] в секции книг;
+///   книги читателей — StringId[member_count];
+///   категории «все», «некоторые», «никто» — StringId[category_counts[i]]
+///   подряд (только при kSnapshotHasResults).
+/// Расположение секций однозначно определяется заголовком, поэтому файл
+/// используется прямо в отображенной памяти.</remarks>
+struct SnapshotHeader {
+  char magic[8];
+  std::uint32_t version;
+  /// <summary>Проверка порядка байтов: kSnapshotByteOrder.</summary>
+  std::uint32_t byte_order;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+  std::uint64_t title_count;
+  std::uint64_t text_bytes;
+  std::uint64_t catalog_count;
+  std::uint64_t reader_count;
+  std::uint64_t member_count;
+  std::uint64_t category_counts[3];
+  /// <summary>Полный размер файла.</summary>
+  std::uint64_t file_size;
+};
+
+/// <summary>Флаг заголовка: снимок содержит результаты анализа.</summary>
+constexpr std::uint32_t kSnapshotHasResults = 1;
+
+/// <summary>Снимок, отображенный в память.</summary>
+/// <remarks>Open проверяет заголовок, размеры секций и массивы смещений
+/// (O(названий + читателей)); сами номера книг не просматриваются, поэтому
+/// загрузка не читает большую часть файла. Номера книг считаются корректными:
+/// файл должен быть записан SnapshotWriter. Все возвращаемые представления
+/// указывают в отображенную память и действительны до Close или уничтожения
+/// объекта.</remarks>
+class BookSnapshot {
+public:
+  BookSnapshot();
+
+  BookSnapshot(const BookSnapshot &) = delete;
+  BookSnapshot &operator=(const BookSnapshot &) = delete;
+
+  /// <summary>Отображает файл снимка и проверяет его.</summary>
+  /// <param name="filename">Имя файла.</param>
+  /// <param name="error">Описание ошибки, если снимок не открыт.</param>
+  /// <returns>true, если снимок готов к использованию.</returns>
+  bool Open(const std::string &filename, std::string &error);
+
+  /// <summary>Снимает отображение.</summary>
+  void Close();
+
+  /// <summary>Возвращает количество названий.</summary>
+  std::size_t TitleCount() const;
+
+  /// <summary>Возвращает название по номеру.</summary>
+  /// <param name="id">Номер меньше TitleCount().</param>
+  std::string_view Title(StringId id) const;
+
+  /// <summary>Возвращает книги каталога.</summary>
+  TitleSpan Catalog() const;
+
+  /// <summary>Возвращает количество читателей.</summary>
+  std::size_t ReaderCount() const;
+
+  /// <summary>Возвращает книги читателя в порядке хранения.</summary>
+  /// <param name="reader">Номер меньше ReaderCount().</param>
+  TitleSpan ReaderBooks(std::size_t reader) const;
+
+  /// <summary>Проверяет, сохранены ли результаты анализа.</summary>
+  bool HasResults() const;
+
+  /// <summary>Возвращает книги категории.</summary>
+  /// <param name="category">0 — все, 1 — некоторые, 2 — никто.</param>
+  /// <returns>Книги категории; пустой отрезок, если результатов нет.</returns>
+  TitleSpan Category(int category) const;
+
+private:
+  MappedFile file_;
+  const SnapshotHeader *header_;
+  const std::uint64_t *title_offsets_;
+  const char *text_;
+  const StringId *catalog_;
+  const std::uint64_t *reader_offsets_;
+  const StringId *members_;
+  const StringId *categories_[3];
+};
+
+/// <summary>Собирает содержимое снимка и записывает его в файл.</summary>
+/// <remarks>Хранит только представления и отрезки: источники (пул строк,
+/// множества) должны жить до вызова Save.</remarks>
+class SnapshotWriter {
+public:
+  SnapshotWriter();
+
+  /// <summary>Добавляет название со следующим номером.</summary>
+  /// <param name="title">Текст названия.</param>
+  void AddTitle(std::string_view title);
+
+  /// <summary>Задает книги каталога.</summary>
+  /// <param name="books">Номера книг.</param>
+  void SetCatalog(TitleSpan books);
+
+  /// <summary>Добавляет читателя.</summary>
+  /// <param name="books">Номера книг читателя.</param>
+  void AddReader(TitleSpan books);
+
+  /// <summary>Задает результаты анализа.</summary>
+  /// <param name="all">Книги, прочитанные всеми.</param>
+  /// <param name="some">Книги, прочитанные некоторыми.</param>
+  /// <param name="none">Книги, которые никто не прочитал.</param>
+  void SetResults(TitleSpan all, TitleSpan some, TitleSpan none);
+
+  /// <summary>Записывает снимок.</summary>
+  /// <param name="filename">Имя файла.</param>
+  /// <returns>true, если файл записан полностью.</returns>
+  bool Save(const std::string &filename) const;
+
+private:
+  std::vector<std::string_view> titles_;
+  TitleSpan catalog_;
+  std::vector<TitleSpan> readers_;
+  bool has_results_;
+  TitleSpan categories_[3];
+};
+
+#endif // SNAPSHOT_H_
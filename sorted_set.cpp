@@ -0,0 +1,281 @@
+#include "sorted_set.h"
+
+#include "metrics.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+template <typename T, typename Compare>
+SortedSet<T, Compare>::SortedSet() : data_(), less_() {}
+
+template <typename T, typename Compare>
+SortedSet<T, Compare>::SortedSet(const Compare &less) : data_(), less_(less) {}
+
+template <typename T, typename Compare>
+SortedSet<T, Compare>::SortedSet(std::vector<T> values)
+    : data_(std::move(values)), less_() {
+  Normalize();
+}
+
+template <typename T, typename Compare>
+UnorderedSet<T> SortedSet<T, Compare>::ToUnorderedSet() const {
+  UnorderedSet<T> result;
+  result.Reserve(data_.size());
+  for (const T &value : data_)
+    result.Add(value);
+  return result;
+}
+
+template <typename T, typename Compare>
+std::size_t SortedSet<T, Compare>::Size() const {
+  return data_.size();
+}
+
+template <typename T, typename Compare>
+bool SortedSet<T, Compare>::Contains(const T &value) const {
+  auto it = std::lower_bound(data_.begin(), data_.end(), value, less_);
+  return it != data_.end() && !less_(value, *it);
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::Add(const T &value) {
+  auto it = std::lower_bound(data_.begin(), data_.end(), value, less_);
+  if (it != data_.end() && !less_(value, *it))
+    return;
+  data_.insert(it, value);
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::Add(T &&value) {
+  auto it = std::lower_bound(data_.begin(), data_.end(), value, less_);
+  if (it != data_.end() && !less_(value, *it))
+    return;
+  data_.insert(it, std::move(value));
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::Reserve(std::size_t count) {
+  data_.reserve(count);
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::ShrinkToFit() {
+  data_.shrink_to_fit();
+}
+
+template <typename T, typename Compare>
+bool SortedSet<T, Compare>::Remove(const T &value) {
+  auto it = std::lower_bound(data_.begin(), data_.end(), value, less_);
+  if (it == data_.end() || less_(value, *it))
+    return false;
+  data_.erase(it);
+  return true;
+}
+
+template <typename T, typename Compare>
+SortedSet<T, Compare>
+SortedSet<T, Compare>::Union(const SortedSet &other) const {
+  METRICS_ADD(kSetOperations, 1);
+  SortedSet result(less_);
+  result.data_.reserve(data_.size() + other.data_.size());
+  std::set_union(data_.begin(), data_.end(), other.data_.begin(),
+                 other.data_.end(), std::back_inserter(result.data_), less_);
+  return result;
+}
+
+template <typename T, typename Compare>
+SortedSet<T, Compare>
+SortedSet<T, Compare>::Except(const SortedSet &other) const {
+  SortedSet result(*this);
+  result.ExceptWith(other);
+  return result;
+}
+
+template <typename T, typename Compare>
+SortedSet<T, Compare>
+SortedSet<T, Compare>::Intersect(const SortedSet &other) const {
+  // Копируется меньшее множество: результат не больше его.
+  SortedSet result(data_.size() <= other.data_.size() ? *this : other);
+  result.IntersectWith(data_.size() <= other.data_.size() ? other : *this);
+  return result;
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::UnionWith(const SortedSet &other) {
+  if (&other == this || other.data_.empty())
+    return;
+  METRICS_ADD(kSetOperations, 1);
+  std::vector<T> merged;
+  merged.reserve(data_.size() + other.data_.size());
+  std::set_union(std::make_move_iterator(data_.begin()),
+                 std::make_move_iterator(data_.end()), other.data_.begin(),
+                 other.data_.end(), std::back_inserter(merged), less_);
+  data_.swap(merged);
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::IntersectWith(const SortedSet &other) {
+  if (&other != this)
+    RetainWhere(other, true);
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::ExceptWith(const SortedSet &other) {
+  if (&other == this)
+    data_.clear();
+  else
+    RetainWhere(other, false);
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::UnionWith(const SortedSet *first,
+                                      const SortedSet *last) {
+  METRICS_ADD(kSetOperations, last - first);
+  std::size_t total = data_.size();
+  for (const SortedSet *set = first; set != last; ++set) {
+    if (set != this)
+      total += set->data_.size();
+  }
+  data_.reserve(total);
+  for (const SortedSet *set = first; set != last; ++set) {
+    if (set != this)
+      data_.insert(data_.end(), set->data_.begin(), set->data_.end());
+  }
+  Normalize();
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::IntersectWith(const SortedSet *first,
+                                          const SortedSet *last) {
+  for (const SortedSet *set = first; set != last && !data_.empty(); ++set)
+    IntersectWith(*set);
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::ExceptWith(const SortedSet *first,
+                                       const SortedSet *last) {
+  for (const SortedSet *set = first; set != last && !data_.empty(); ++set)
+    ExceptWith(*set);
+}
+
+template <typename T, typename Compare>
+typename SortedSet<T, Compare>::const_iterator
+SortedSet<T, Compare>::begin() const {
+  return data_.data();
+}
+
+template <typename T, typename Compare>
+typename SortedSet<T, Compare>::const_iterator
+SortedSet<T, Compare>::end() const {
+  return data_.data() + data_.size();
+}
+
+template <typename T, typename Compare>
+std::vector<T> SortedSet<T, Compare>::ToVector() const {
+  return data_;
+}
+
+template <typename T, typename Compare> void SortedSet<T, Compare>::Clear() {
+  data_.clear();
+}
+
+template <typename T, typename Compare>
+bool SortedSet<T, Compare>::IsEmpty() const {
+  return data_.empty();
+}
+
+template <typename T, typename Compare>
+std::size_t SortedSet<T, Compare>::Gallop(const std::vector<T> &values,
+                                          std::size_t from,
+                                          const T &value) const {
+  std::size_t size = values.size();
+  std::size_t step = 1;
+  std::size_t low = from;
+  std::size_t high = from;
+  while (high < size && less_(values[high], value)) {
+    low = high + 1;
+    high = from + step;
+    step *= 2;
+  }
+  if (high > size)
+    high = size;
+  return static_cast<std::size_t>(
+      std::lower_bound(values.begin() + static_cast<std::ptrdiff_t>(low),
+                       values.begin() + static_cast<std::ptrdiff_t>(high),
+                       value, less_) -
+      values.begin());
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::Normalize() {
+  std::sort(data_.begin(), data_.end(), less_);
+  const Compare &less = less_;
+  data_.erase(std::unique(data_.begin(), data_.end(),
+                          [&less](const T &a, const T &b) {
+                            return !less(a, b) && !less(b, a);
+                          }),
+              data_.end());
+}
+
+template <typename T, typename Compare>
+void SortedSet<T, Compare>::RetainWhere(const SortedSet &other,
+                                        bool keep_present) {
+  METRICS_ADD(kSetOperations, 1);
+  const std::vector<T> &theirs = other.data_;
+  std::size_t kept = 0;
+  std::size_t i = 0;
+  auto keep = [this, &kept](std::size_t index) {
+    if (kept != index)
+      data_[kept] = std::move(data_[index]);
+    ++kept;
+  };
+
+  if (data_.size() * kGallopRatio <= theirs.size()) {
+    // Текущее множество намного меньше: каждый его элемент ищется в other
+    // галопом от позиции предыдущего.
+    std::size_t pos = 0;
+    for (; i < data_.size(); ++i) {
+      pos = Gallop(theirs, pos, data_[i]);
+      bool present = pos < theirs.size() && !less_(data_[i], theirs[pos]);
+      if (present == keep_present)
+        keep(i);
+    }
+  } else if (theirs.size() * kGallopRatio <= data_.size()) {
+    // other намного меньше: галопом по текущему множеству от элемента к
+    // элементу other; промежутки между ними переносятся целиком (разность)
+    // или пропускаются (пересечение).
+    for (std::size_t j = 0; j < theirs.size() && i < data_.size(); ++j) {
+      std::size_t pos = Gallop(data_, i, theirs[j]);
+      if (!keep_present) {
+        for (; i < pos; ++i)
+          keep(i);
+      }
+      i = pos;
+      if (i < data_.size() && !less_(theirs[j], data_[i])) {
+        if (keep_present)
+          keep(i);
+        ++i;
+      }
+    }
+    if (!keep_present) {
+      for (; i < data_.size(); ++i)
+        keep(i);
+    }
+  } else {
+    // Размеры сравнимы: линейное слияние.
+    std::size_t j = 0;
+    for (; i < data_.size(); ++i) {
+      while (j < theirs.size() && less_(theirs[j], data_[i]))
+        ++j;
+      bool present = j < theirs.size() && !less_(data_[i], theirs[j]);
+      if (present == keep_present)
+        keep(i);
+    }
+  }
+  data_.erase(data_.begin() + static_cast<std::ptrdiff_t>(kept), data_.end());
+}
+
+template class SortedSet<int>;
+template class SortedSet<std::uint32_t>;
+template class SortedSet<std::string>;
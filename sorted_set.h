@@ -0,0 +1,221 @@
+#ifndef SORTED_SET_H_
+#define SORTED_SET_H_
+
+#include "metrics.h"
+#include "unordered_set.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+/// <summary>Множество уникальных элементов в отсортированном непрерывном
+/// массиве.</summary> <typeparam name="T">Тип элементов.</typeparam>
+/// <typeparam name="Compare">Строгий порядок элементов.</typeparam>
+/// <remarks>Вариант UnorderedSet для данных, которые в основном читаются:
+/// Contains — двоичный поиск, Union/Except/Intersect — линейное слияние, а
+/// при сильно различающихся размерах Intersect и Except «галопируют» по
+/// большему множеству (экспоненциальный поиск от последней найденной
+/// позиции), что стоит O(m log(n/m)). Add и Remove сдвигают хвост массива и
+/// работают за O(n). Элементы перечисляются в порядке Compare.
+/// Итераторы — константные указатели в массив; любое изменение множества
+/// делает их недействительными.</remarks>
+template <typename T, typename Compare = std::less<T>> class SortedSet {
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using const_iterator = const T *;
+  using iterator = const_iterator;
+
+  /// <summary>Конструктор по умолчанию. Создает пустое множество.</summary>
+  SortedSet();
+
+  /// <summary>Создает пустое множество с заданным порядком.</summary>
+  /// <param name="less">Строгий порядок элементов.</param>
+  explicit SortedSet(const Compare &less);
+
+  /// <summary>Создает множество из произвольного набора значений.</summary>
+  /// <param name="values">Значения; сортируются, повторы отбрасываются.</param>
+  explicit SortedSet(std::vector<T> values);
+
+  /// <summary>Создает множество из элементов UnorderedSet.</summary>
+  /// <param name="set">Исходное множество.</param>
+  /// <remarks>O(n log n); если элементы уже добавлены в порядке Compare —
+  /// O(n).</remarks>
+  template <typename Hash, typename KeyEqual, typename Allocator,
+            std::size_t InlineCapacity>
+  explicit SortedSet(
+      const UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity> &set);
+
+  /// <summary>Возвращает элементы в виде UnorderedSet (в порядке
+  /// Compare).</summary>
+  UnorderedSet<T> ToUnorderedSet() const;
+
+  /// <summary>Возвращает количество элементов в множестве.</summary>
+  std::size_t Size() const;
+
+  /// <summary>Проверяет наличие элемента (двоичный поиск).</summary>
+  /// <param name="value">Элемент для проверки.</param>
+  bool Contains(const T &value) const;
+
+  /// <summary>Добавляет элемент в множество.</summary>
+  /// <param name="value">Элемент для добавления.</param>
+  /// <remarks>Если элемент уже существует, добавление не происходит.</remarks>
+  void Add(const T &value);
+
+  /// <summary>Добавляет элемент в множество перемещением.</summary>
+  /// <param name="value">Элемент для добавления.</param>
+  void Add(T &&value);
+
+  /// <summary>Конструирует элемент из аргументов и добавляет его.</summary>
+  /// <param name="args">Аргументы конструктора T.</param>
+  /// <returns>true, если элемент добавлен; false, если такой уже
+  /// был.</returns>
+  template <typename... Args> bool Emplace(Args &&...args);
+
+  /// <summary>Заранее выделяет место под count элементов.</summary>
+  void Reserve(std::size_t count);
+
+  /// <summary>Освобождает неиспользуемую емкость.</summary>
+  void ShrinkToFit();
+
+  /// <summary>Удаляет элемент из множества.</summary>
+  /// <param name="value">Элемент для удаления.</param>
+  /// <returns>true, если элемент был удален, иначе false.</returns>
+  bool Remove(const T &value);
+
+  /// <summary>Объединение (слияние).</summary>
+  SortedSet Union(const SortedSet &other) const;
+
+  /// <summary>Элементы текущего множества, отсутствующие в other.</summary>
+  SortedSet Except(const SortedSet &other) const;
+
+  /// <summary>Пересечение.</summary>
+  SortedSet Intersect(const SortedSet &other) const;
+
+  /// <summary>Добавляет элементы другого множества (слияние).</summary>
+  void UnionWith(const SortedSet &other);
+
+  /// <summary>Оставляет только общие с other элементы, на месте.</summary>
+  void IntersectWith(const SortedSet &other);
+
+  /// <summary>Оставляет только элементы, присутствующие в хеш-множестве
+  /// other.</summary>
+  /// <param name="other">Хеш-множество.</param>
+  /// <remarks>O(Size()) проверок по хеш-таблице без сортировки other —
+  /// выгодно, когда текущее множество намного меньше other.</remarks>
+  template <typename Hash, typename KeyEqual, typename Allocator,
+            std::size_t InlineCapacity>
+  void IntersectWith(
+      const UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity> &other);
+
+  /// <summary>Удаляет элементы, присутствующие в other, на месте.</summary>
+  void ExceptWith(const SortedSet &other);
+
+  /// <summary>Добавляет элементы всех множеств диапазона.</summary>
+  /// <remarks>Элементы собираются в один массив, сортируются и очищаются от
+  /// повторов: O(N log N) для N элементов всего.</remarks>
+  void UnionWith(const SortedSet *first, const SortedSet *last);
+
+  /// <summary>Оставляет элементы, присутствующие во всех множествах
+  /// диапазона.</summary>
+  void IntersectWith(const SortedSet *first, const SortedSet *last);
+
+  /// <summary>Удаляет элементы, присутствующие хотя бы в одном множестве
+  /// диапазона.</summary>
+  void ExceptWith(const SortedSet *first, const SortedSet *last);
+
+  /// <summary>Итератор на наименьший элемент.</summary>
+  const_iterator begin() const;
+
+  /// <summary>Итератор за наибольшим элементом.</summary>
+  const_iterator end() const;
+
+  /// <summary>Вызывает visitor(элемент) для каждого элемента в порядке
+  /// Compare.</summary>
+  template <typename Visitor> void ForEach(Visitor visitor) const;
+
+  /// <summary>Возвращает элементы в порядке Compare.</summary>
+  std::vector<T> ToVector() const;
+
+  /// <summary>Очищает множество, удаляя все элементы.</summary>
+  void Clear();
+
+  /// <summary>Проверяет, пусто ли множество.</summary>
+  bool IsEmpty() const;
+
+private:
+  /// <summary>Во сколько раз одно множество должно быть больше другого, чтобы
+  /// вместо слияния использовать галопирующий поиск.</summary>
+  static constexpr std::size_t kGallopRatio = 16;
+
+  std::vector<T> data_;
+  Compare less_;
+
+  /// <summary>Первая позиция не раньше from, где элемент не меньше
+  /// value.</summary>
+  /// <param name="values">Отсортированный массив.</param>
+  /// <param name="from">Начальная позиция поиска.</param>
+  /// <param name="value">Искомое значение.</param>
+  /// <remarks>Шаг удваивается, пока не перешагнет value, затем двоичный поиск
+  /// в последнем отрезке.</remarks>
+  std::size_t Gallop(const std::vector<T> &values, std::size_t from,
+                     const T &value) const;
+
+  /// <summary>Сортирует data_ и удаляет повторы.</summary>
+  void Normalize();
+
+  /// <summary>Оставляет элементы, которые есть (keep_present) или которых
+  /// нет в other, сохраняя порядок.</summary>
+  void RetainWhere(const SortedSet &other, bool keep_present);
+};
+
+template <typename T, typename Compare>
+template <typename Hash, typename KeyEqual, typename Allocator,
+            std::size_t InlineCapacity>
+SortedSet<T, Compare>::SortedSet(
+    const UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity> &set)
+    : data_(set.begin(), set.end()), less_() {
+  // Элементы UnorderedSet уникальны, повторы отбрасывать не нужно.
+  if (!std::is_sorted(data_.begin(), data_.end(), less_))
+    std::sort(data_.begin(), data_.end(), less_);
+}
+
+template <typename T, typename Compare>
+template <typename Hash, typename KeyEqual, typename Allocator,
+            std::size_t InlineCapacity>
+void SortedSet<T, Compare>::IntersectWith(
+    const UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity> &other) {
+  METRICS_ADD(kSetOperations, 1);
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < data_.size(); ++i) {
+    if (!other.Contains(data_[i]))
+      continue;
+    if (kept != i)
+      data_[kept] = std::move(data_[i]);
+    ++kept;
+  }
+  data_.erase(data_.begin() + static_cast<std::ptrdiff_t>(kept), data_.end());
+}
+
+template <typename T, typename Compare>
+template <typename Visitor>
+void SortedSet<T, Compare>::ForEach(Visitor visitor) const {
+  for (const T &value : data_)
+    visitor(value);
+}
+
+template <typename T, typename Compare>
+template <typename... Args>
+bool SortedSet<T, Compare>::Emplace(Args &&...args) {
+  T value(std::forward<Args>(args)...);
+  auto it = std::lower_bound(data_.begin(), data_.end(), value, less_);
+  if (it != data_.end() && !less_(value, *it))
+    return false;
+  data_.insert(it, std::move(value));
+  return true;
+}
+
+#endif // SORTED_SET_H_
@@ -0,0 +1,47 @@
+#ifndef STRING_HASH_H_
+#define STRING_HASH_H_
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
+/// <summary>Хеш строк, принимающий std::string, std::string_view и
+/// const char*.</summary>
+/// <remarks>Прозрачный (объявляет is_transparent): UnorderedSet и
+/// Dictionary с ключом std::string, StringHash и StringEqual ищут по
+/// std::string_view без временной строки. Значение равно
+/// std::hash&lt;std::string_view&gt;, поэтому строка и ее представление дают
+/// один хеш.</remarks>
+struct StringHash {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view str) const noexcept {
+    return std::hash<std::string_view>()(str);
+  }
+};
+
+/// <summary>Равенство строк для StringHash.</summary>
+struct StringEqual {
+  using is_transparent = void;
+
+  bool operator()(std::string_view a, std::string_view b) const noexcept {
+    return a == b;
+  }
+};
+
+/// <summary>true, если Hash и KeyEqual прозрачны и контейнер может искать
+/// по ключу типа Key, не строя элемент.</summary>
+/// <remarks>Key в условии не участвует; он делает проверку зависимой от
+/// аргумента шаблона метода, чтобы непрозрачные контейнеры просто не видели
+/// таких перегрузок (SFINAE).</remarks>
+template <typename Hash, typename KeyEqual, typename Key, typename = void>
+struct IsTransparentLookup : std::false_type {};
+
+template <typename Hash, typename KeyEqual, typename Key>
+struct IsTransparentLookup<Hash, KeyEqual, Key,
+                           std::void_t<typename Hash::is_transparent,
+                                       typename KeyEqual::is_transparent>>
+    : std::true_type {};
+
+#endif // STRING_HASH_H_
@@ -0,0 +1,79 @@
+#include "string_pool.h"
+
+#include <cstring>
+#include <utility>
+
+StringPool::StringPool()
+    : blocks_(), block_used_(0), block_capacity_(0), text_bytes_(0),
+      views_(), index_() {}
+
+StringPool::StringPool(StringPool &&other) noexcept
+    : blocks_(std::move(other.blocks_)), block_used_(other.block_used_),
+      block_capacity_(other.block_capacity_), text_bytes_(other.text_bytes_),
+      views_(std::move(other.views_)), index_(std::move(other.index_)) {
+  other.block_used_ = 0;
+  other.block_capacity_ = 0;
+  other.text_bytes_ = 0;
+}
+
+StringPool &StringPool::operator=(StringPool &&other) noexcept {
+  if (this != &other) {
+    blocks_ = std::move(other.blocks_);
+    block_used_ = other.block_used_;
+    block_capacity_ = other.block_capacity_;
+    text_bytes_ = other.text_bytes_;
+    views_ = std::move(other.views_);
+    index_ = std::move(other.index_);
+    other.block_used_ = 0;
+    other.block_capacity_ = 0;
+    other.text_bytes_ = 0;
+  }
+  return *this;
+}
+
+StringId StringPool::Intern(std::string_view str) {
+  if (const StringId *id = index_.Get(str))
+    return *id;
+  std::string_view stored = Store(str);
+  StringId id = static_cast<StringId>(views_.size());
+  views_.push_back(stored);
+  index_.Add(stored, id);
+  return id;
+}
+
+StringId StringPool::Find(std::string_view str) const {
+  const StringId *id = index_.Get(str);
+  return id == nullptr ? kNoString : *id;
+}
+
+std::string_view StringPool::View(StringId id) const { return views_[id]; }
+
+std::size_t StringPool::Size() const { return views_.size(); }
+
+std::size_t StringPool::TextBytes() const { return text_bytes_; }
+
+void StringPool::Clear() {
+  index_.Clear();
+  views_.clear();
+  blocks_.clear();
+  block_used_ = 0;
+  block_capacity_ = 0;
+  text_bytes_ = 0;
+}
+
+std::string_view StringPool::Store(std::string_view str) {
+  if (str.empty())
+    return std::string_view();
+  if (block_capacity_ - block_used_ < str.size()) {
+    // Строки длиннее блока получают собственный блок точного размера.
+    std::size_t size = str.size() > kBlockSize ? str.size() : kBlockSize;
+    blocks_.emplace_back(new char[size]);
+    block_used_ = 0;
+    block_capacity_ = size;
+  }
+  char *dst = blocks_.back().get() + block_used_;
+  std::memcpy(dst, str.data(), str.size());
+  block_used_ += str.size();
+  text_bytes_ += str.size();
+  return std::string_view(dst, str.size());
+}
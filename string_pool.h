@@ -0,0 +1,78 @@
+#ifndef STRING_POOL_H_
+#define STRING_POOL_H_
+
+#include "dictionary.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/// <summary>Компактный дескриптор строки в StringPool.</summary>
+/// <remarks>Номера выдаются подряд с нуля в порядке первого появления
+/// строки, поэтому годятся как плотные индексы.</remarks>
+using StringId = std::uint32_t;
+
+/// <summary>Пул интернированных строк.</summary>
+/// <remarks>Каждая различная строка хранится ровно один раз в арене из
+/// крупных блоков; блоки не перемещаются, поэтому выданные std::string_view
+/// остаются действительными до уничтожения пула. Равенство интернированных
+/// строк сводится к сравнению StringId.</remarks>
+class StringPool {
+public:
+  /// <summary>Значение, возвращаемое Find для отсутствующей строки.</summary>
+  static constexpr StringId kNoString = static_cast<StringId>(-1);
+
+  /// <summary>Конструктор по умолчанию. Создает пустой пул.</summary>
+  StringPool();
+
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+  StringPool(StringPool &&other) noexcept;
+  StringPool &operator=(StringPool &&other) noexcept;
+
+  /// <summary>Возвращает дескриптор строки, при необходимости копируя ее в
+  /// арену.</summary>
+  /// <param name="str">Строка.</param>
+  /// <returns>Дескриптор строки.</returns>
+  StringId Intern(std::string_view str);
+
+  /// <summary>Ищет строку без добавления.</summary>
+  /// <param name="str">Строка.</param>
+  /// <returns>Дескриптор или kNoString, если строка не интернирована.</returns>
+  StringId Find(std::string_view str) const;
+
+  /// <summary>Возвращает строку по дескриптору.</summary>
+  /// <param name="id">Дескриптор, выданный этим пулом.</param>
+  /// <returns>Представление строки внутри арены.</returns>
+  std::string_view View(StringId id) const;
+
+  /// <summary>Возвращает количество различных строк.</summary>
+  /// <returns>Количество строк.</returns>
+  std::size_t Size() const;
+
+  /// <summary>Возвращает суммарный размер текста строк в байтах.</summary>
+  /// <returns>Количество занятых байтов арены.</returns>
+  std::size_t TextBytes() const;
+
+  /// <summary>Удаляет все строки и освобождает арену.</summary>
+  void Clear();
+
+private:
+  static constexpr std::size_t kBlockSize = 64 * 1024;
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::size_t block_used_;
+  std::size_t block_capacity_;
+  std::size_t text_bytes_;
+  std::vector<std::string_view> views_;
+  Dictionary<std::string_view, StringId> index_;
+
+  /// <summary>Копирует байты строки в арену.</summary>
+  /// <param name="str">Строка.</param>
+  /// <returns>Представление копии внутри арены.</returns>
+  std::string_view Store(std::string_view str);
+};
+
+#endif // STRING_POOL_H_
@@ -0,0 +1,100 @@
+#include "thread_pool.h"
+
+namespace {
+
+/// Признак того, что текущий поток выполняет итерацию ParallelFor.
+thread_local bool tls_inside_pool = false;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+    : workers_(), body_(nullptr), count_(0), next_(0), finished_(0),
+      active_(0), generation_(0), stop_(false) {
+  if (thread_count == 0)
+    thread_count = std::thread::hardware_concurrency();
+  if (thread_count == 0)
+    thread_count = 1;
+  workers_.reserve(thread_count - 1);
+  for (std::size_t i = 1; i < thread_count; ++i)
+    workers_.emplace_back([this] { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto &worker : workers_)
+    worker.join();
+}
+
+std::size_t ThreadPool::ThreadCount() const { return workers_.size() + 1; }
+
+void ThreadPool::ParallelFor(std::size_t count,
+                             const std::function<void(std::size_t)> &body) {
+  if (count == 0)
+    return;
+  if (workers_.empty() || count == 1 || tls_inside_pool) {
+    for (std::size_t i = 0; i < count; ++i)
+      body(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> submit(submit_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    body_ = &body;
+    count_ = count;
+    next_.store(0, std::memory_order_relaxed);
+    finished_ = 0;
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  std::size_t done = RunIterations(body, count);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  finished_ += done;
+  // Ждем не только завершения итераций, но и выхода всех рабочих из
+  // задания: иначе опоздавший поток мог бы взять номер следующего задания.
+  done_.wait(lock, [this] { return finished_ == count_ && active_ == 0; });
+  body_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+  std::size_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+    if (stop_)
+      return;
+    seen = generation_;
+    if (body_ == nullptr)
+      continue;
+    const std::function<void(std::size_t)> *body = body_;
+    std::size_t count = count_;
+    ++active_;
+    lock.unlock();
+    std::size_t done = RunIterations(*body, count);
+    lock.lock();
+    finished_ += done;
+    --active_;
+    if (finished_ == count_ && active_ == 0)
+      done_.notify_one();
+  }
+}
+
+std::size_t
+ThreadPool::RunIterations(const std::function<void(std::size_t)> &body,
+                          std::size_t count) {
+  tls_inside_pool = true;
+  std::size_t done = 0;
+  for (std::size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+       i < count; i = next_.fetch_add(1, std::memory_order_relaxed)) {
+    body(i);
+    ++done;
+  }
+  tls_inside_pool = false;
+  return done;
+}
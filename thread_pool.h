@@ -0,0 +1,72 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>Простой пул потоков для параллельных циклов.</summary>
+/// <remarks>Рабочие потоки создаются один раз и ждут задания. ParallelFor
+/// раздает номера итераций динамически (через атомарный счетчик), вызывающий
+/// поток участвует в работе наравне с рабочими. Вложенный ParallelFor,
+/// вызванный изнутри итерации, выполняется последовательно в текущем
+/// потоке.</remarks>
+class ThreadPool {
+public:
+  /// <summary>Создает пул.</summary>
+  /// <param name="thread_count">Общее число потоков с учетом вызывающего;
+  /// 0 — по числу аппаратных потоков.</param>
+  explicit ThreadPool(std::size_t thread_count = 0);
+
+  /// <summary>Деструктор. Останавливает и присоединяет рабочие
+  /// потоки.</summary>
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// <summary>Возвращает общее число потоков с учетом вызывающего.</summary>
+  /// <returns>Число потоков.</returns>
+  std::size_t ThreadCount() const;
+
+  /// <summary>Выполняет body(i) для всех i из [0, count) и дожидается
+  /// завершения.</summary>
+  /// <param name="count">Число итераций.</param>
+  /// <param name="body">Тело цикла; итерации выполняются в произвольном
+  /// порядке, должны быть независимыми и не должны бросать
+  /// исключений.</param>
+  void ParallelFor(std::size_t count,
+                   const std::function<void(std::size_t)> &body);
+
+private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  /// <summary>Сериализует одновременные вызовы ParallelFor.</summary>
+  std::mutex submit_mutex_;
+  const std::function<void(std::size_t)> *body_;
+  std::size_t count_;
+  std::atomic<std::size_t> next_;
+  std::size_t finished_;
+  /// <summary>Число рабочих, взявших текущее задание.</summary>
+  std::size_t active_;
+  std::size_t generation_;
+  bool stop_;
+
+  /// <summary>Цикл рабочего потока.</summary>
+  void WorkerLoop();
+
+  /// <summary>Забирает и выполняет итерации текущего задания.</summary>
+  /// <param name="body">Тело цикла.</param>
+  /// <param name="count">Число итераций задания.</param>
+  /// <returns>Количество выполненных итераций.</returns>
+  std::size_t RunIterations(const std::function<void(std::size_t)> &body,
+                            std::size_t count);
+};
+
+#endif // THREAD_POOL_H_
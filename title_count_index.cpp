@@ -0,0 +1,97 @@
+#include "title_count_index.h"
+
+#include <utility>
+
+TitleCountIndex::TitleCountIndex() : order_(), pos_(), count_(), bound_(2, 0) {}
+
+void TitleCountIndex::Reset(std::size_t title_count) {
+  order_.resize(title_count);
+  pos_.resize(title_count);
+  count_.assign(title_count, 0);
+  for (std::size_t i = 0; i < title_count; ++i) {
+    order_[i] = static_cast<StringId>(i);
+    pos_[i] = i;
+  }
+  bound_.assign(2, 0);
+  bound_[0] = title_count;
+}
+
+void TitleCountIndex::AddTitle() {
+  // Новая книга со счетчиком 0 попадает в конец order_ — в отрезок «никто».
+  std::size_t id = order_.size();
+  order_.push_back(static_cast<StringId>(id));
+  pos_.push_back(id);
+  count_.push_back(0);
+  ++bound_[0];
+}
+
+void TitleCountIndex::AddReader(TitleSpan books) {
+  bound_.push_back(0);
+  for (std::size_t i = 0; i < books.size; ++i) {
+    Increment(books.data[i]);
+  }
+}
+
+void TitleCountIndex::RemoveReader(TitleSpan books) {
+  for (std::size_t i = 0; i < books.size; ++i) {
+    Decrement(books.data[i]);
+  }
+  bound_.pop_back();
+}
+
+std::size_t TitleCountIndex::TitleCount() const { return order_.size(); }
+
+std::size_t TitleCountIndex::ReaderCount() const { return bound_.size() - 2; }
+
+std::size_t TitleCountIndex::Count(StringId id) const { return count_[id]; }
+
+TitleSpan TitleCountIndex::ReadByAll() const {
+  std::size_t readers = ReaderCount();
+  if (readers == 0)
+    return TitleSpan{nullptr, 0};
+  return Range(0, bound_[readers]);
+}
+
+TitleSpan TitleCountIndex::ReadBySome() const {
+  std::size_t readers = ReaderCount();
+  if (readers == 0)
+    return TitleSpan{nullptr, 0};
+  return Range(bound_[readers], bound_[1]);
+}
+
+TitleSpan TitleCountIndex::ReadByNone() const {
+  return Range(bound_[1], bound_[0]);
+}
+
+TitleSpan TitleCountIndex::ReadByAtLeast(std::size_t count) const {
+  if (count >= bound_.size())
+    return TitleSpan{nullptr, 0};
+  return Range(0, bound_[count]);
+}
+
+void TitleCountIndex::Increment(StringId id) {
+  // Книга переходит из отрезка c в отрезок c+1: меняем ее местами с первой
+  // книгой отрезка c и сдвигаем границу.
+  std::size_t c = count_[id];
+  SwapPositions(pos_[id], bound_[c + 1]);
+  ++bound_[c + 1];
+  count_[id] = c + 1;
+}
+
+void TitleCountIndex::Decrement(StringId id) {
+  // Симметрично: меняем с последней книгой отрезка c.
+  std::size_t c = count_[id];
+  SwapPositions(pos_[id], bound_[c] - 1);
+  --bound_[c];
+  count_[id] = c - 1;
+}
+
+void TitleCountIndex::SwapPositions(std::size_t a, std::size_t b) {
+  std::swap(order_[a], order_[b]);
+  pos_[order_[a]] = a;
+  pos_[order_[b]] = b;
+}
+
+TitleSpan TitleCountIndex::Range(std::size_t begin, std::size_t end) const {
+  return TitleSpan{order_.data() + begin, end - begin};
+}
@@ -0,0 +1,94 @@
+#ifndef TITLE_COUNT_INDEX_H_
+#define TITLE_COUNT_INDEX_H_
+
+#include "string_pool.h"
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>Отрезок номеров книг без копирования.</summary>
+/// <remarks>Действителен до следующего изменения источника.</remarks>
+struct TitleSpan {
+  const StringId *data;
+  std::size_t size;
+};
+
+/// <summary>Счетчики читателей по книгам для инкрементального
+/// анализа.</summary> <remarks>Хранит для каждой книги (плотный StringId)
+/// число прочитавших ее читателей. Книги дополнительно упорядочены по
+/// убыванию счетчика в массиве order_, а bound_[c] — количество книг со
+/// счетчиком не меньше c. Изменение счетчика на единицу — это обмен двух
+/// элементов order_ и сдвиг одной границы, то есть O(1). Поэтому категории
+/// «все» (счетчик = числу читателей), «некоторые» и «никто» (счетчик = 0)
+/// всегда являются непрерывными отрезками order_, а добавление или удаление
+/// читателя стоит O(число его книг).</remarks>
+class TitleCountIndex {
+public:
+  /// <summary>Конструктор по умолчанию. Нет ни книг, ни читателей.</summary>
+  TitleCountIndex();
+
+  /// <summary>Сбрасывает индекс: title_count книг с нулевыми счетчиками, ни
+  /// одного читателя.</summary>
+  /// <param name="title_count">Количество книг (номера 0..title_count-1).</param>
+  void Reset(std::size_t title_count);
+
+  /// <summary>Регистрирует новую книгу с номером TitleCount() и нулевым
+  /// счетчиком.</summary>
+  void AddTitle();
+
+  /// <summary>Учитывает нового читателя.</summary>
+  /// <param name="books">Книги читателя без повторов (номера меньше
+  /// TitleCount()).</param>
+  void AddReader(TitleSpan books);
+
+  /// <summary>Исключает ранее учтенного читателя.</summary>
+  /// <param name="books">Книги читателя — те же, что были переданы в
+  /// AddReader.</param>
+  void RemoveReader(TitleSpan books);
+
+  /// <summary>Возвращает количество книг.</summary>
+  std::size_t TitleCount() const;
+
+  /// <summary>Возвращает количество учтенных читателей.</summary>
+  std::size_t ReaderCount() const;
+
+  /// <summary>Возвращает число читателей книги.</summary>
+  /// <param name="id">Номер книги.</param>
+  std::size_t Count(StringId id) const;
+
+  /// <summary>Книги, прочитанные всеми читателями.</summary>
+  /// <returns>Отрезок внутреннего массива, до следующего изменения.</returns>
+  TitleSpan ReadByAll() const;
+
+  /// <summary>Книги, прочитанные некоторыми (но не всеми) читателями.</summary>
+  /// <returns>Отрезок внутреннего массива, до следующего изменения.</returns>
+  TitleSpan ReadBySome() const;
+
+  /// <summary>Книги, которые никто не прочитал.</summary>
+  /// <returns>Отрезок внутреннего массива, до следующего изменения.</returns>
+  TitleSpan ReadByNone() const;
+
+  /// <summary>Книги, прочитанные не меньше чем count читателями.</summary>
+  /// <param name="count">Наименьшее число читателей.</param>
+  /// <returns>Отрезок внутреннего массива по убыванию счетчика, до
+  /// следующего изменения; O(1).</returns>
+  TitleSpan ReadByAtLeast(std::size_t count) const;
+
+private:
+  /// <summary>Книги по убыванию счетчика.</summary>
+  std::vector<StringId> order_;
+  /// <summary>Позиция каждой книги в order_.</summary>
+  std::vector<std::size_t> pos_;
+  /// <summary>Счетчик читателей каждой книги.</summary>
+  std::vector<std::size_t> count_;
+  /// <summary>bound_[c] — число книг со счетчиком не меньше c; размер —
+  /// ReaderCount() + 2.</summary>
+  std::vector<std::size_t> bound_;
+
+  void Increment(StringId id);
+  void Decrement(StringId id);
+  void SwapPositions(std::size_t a, std::size_t b);
+  TitleSpan Range(std::size_t begin, std::size_t end) const;
+};
+
+#endif // TITLE_COUNT_INDEX_H_
@@ -1,158 +1,664 @@
 #include "unordered_set.h"
 
+#include "allocators.h"
+#include "metrics.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <new>
 #include <string>
 #include <utility>
 
-template <typename T>
-UnorderedSet<T>::UnorderedSet() : data_(nullptr), size_(0), capacity_(0) {}
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnorderedSet()
+    : data_(InlineData()), hashes_(InlineHashes()), slots_(nullptr),
+      size_(0), capacity_(InlineCapacity), hash_(), equal_(), allocator_() {}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnorderedSet(
+    const Allocator &allocator)
+    : data_(InlineData()), hashes_(InlineHashes()), slots_(nullptr),
+      size_(0), capacity_(InlineCapacity), hash_(), equal_(),
+      allocator_(allocator) {}
 
-template <typename T> UnorderedSet<T>::~UnorderedSet() { delete[] data_; }
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnorderedSet(
+    const Hash &hash, const KeyEqual &equal, const Allocator &allocator)
+    : data_(InlineData()), hashes_(InlineHashes()), slots_(nullptr),
+      size_(0), capacity_(InlineCapacity), hash_(hash), equal_(equal),
+      allocator_(allocator) {}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::~UnorderedSet() {
+  Release();
+}
 
-template <typename T>
-UnorderedSet<T>::UnorderedSet(const UnorderedSet &other)
-    : data_(nullptr), size_(0), capacity_(0) {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnorderedSet(
+    const UnorderedSet &other)
+    : data_(InlineData()), hashes_(InlineHashes()), slots_(nullptr),
+      size_(0), capacity_(InlineCapacity), hash_(other.hash_),
+      equal_(other.equal_),
+      allocator_(AllocTraits::select_on_container_copy_construction(
+          other.allocator_)) {
   EnsureCapacity(other.size_);
-  for (std::size_t i = 0; i < other.size_; ++i) {
-    data_[i] = other.data_[i];
+  try {
+    for (; size_ < other.size_; ++size_) {
+      new (data_ + size_) T(other.data_[size_]);
+      hashes_[size_] = other.hashes_[size_];
+    }
+  } catch (...) {
+    Release();
+    throw;
+  }
+  if (slots_ != nullptr && capacity_ == other.capacity_) {
+    std::memcpy(slots_, other.slots_, 2 * capacity_ * sizeof(std::size_t));
+  } else {
+    for (std::size_t i = 0; i < size_; ++i) {
+      InsertSlot(i);
+    }
   }
-  size_ = other.size_;
 }
 
-template <typename T>
-UnorderedSet<T> &UnorderedSet<T>::operator=(const UnorderedSet &other) {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity> &
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::operator=(
+    const UnorderedSet &other) {
   if (this != &other) {
     UnorderedSet temp(other);
-    Swap(temp);
+    Release();
+    TakeFrom(temp);
   }
   return *this;
 }
 
-template <typename T>
-UnorderedSet<T>::UnorderedSet(UnorderedSet &&other) noexcept
-    : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
-  other.data_ = nullptr;
-  other.size_ = 0;
-  other.capacity_ = 0;
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnorderedSet(
+    UnorderedSet &&other) noexcept(kNothrowMove)
+    : data_(InlineData()), hashes_(InlineHashes()), slots_(nullptr),
+      size_(0), capacity_(InlineCapacity), hash_(other.hash_),
+      equal_(other.equal_), allocator_(other.allocator_) {
+  TakeFrom(other);
 }
 
-template <typename T>
-UnorderedSet<T> &UnorderedSet<T>::operator=(UnorderedSet &&other) noexcept {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity> &
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::operator=(
+    UnorderedSet &&other) noexcept(kNothrowMove) {
   if (this != &other) {
-    delete[] data_;
-    data_ = other.data_;
-    size_ = other.size_;
-    capacity_ = other.capacity_;
-    other.data_ = nullptr;
-    other.size_ = 0;
-    other.capacity_ = 0;
+    Release();
+    TakeFrom(other);
   }
   return *this;
 }
 
-template <typename T> std::size_t UnorderedSet<T>::Size() const {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+std::size_t UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Size() const {
   return size_;
 }
 
-template <typename T> bool UnorderedSet<T>::Contains(const T &value) const {
-  return Find(value) != kNotFound;
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+Allocator UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::GetAllocator() const {
+  return allocator_;
 }
 
-template <typename T> void UnorderedSet<T>::Add(const T &value) {
-  if (Contains(value))
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+bool UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Contains(
+    const T &value) const {
+  return Find(value, HashOf(value)) != kNotFound;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Add(const T &value) {
+  std::size_t hash = HashOf(value);
+  if (Find(value, hash) != kNotFound)
     return;
-  EnsureCapacity(size_ + 1);
-  data_[size_++] = value;
+  AppendNew(value, hash);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Add(T &&value) {
+  std::size_t hash = HashOf(value);
+  if (Find(value, hash) != kNotFound)
+    return;
+  AppendNew(std::move(value), hash);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Reserve(std::size_t count) {
+  EnsureCapacity(count);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::ShrinkToFit() {
+  if (slots_ == nullptr)
+    return;
+  if (size_ == 0) {
+    Release();
+    return;
+  }
+  if (size_ <= InlineCapacity) {
+    Reallocate(InlineCapacity);
+    return;
+  }
+  std::size_t new_capacity = kInitialCapacity;
+  while (new_capacity < size_)
+    new_capacity *= 2;
+  if (new_capacity < capacity_)
+    Reallocate(new_capacity);
 }
 
-template <typename T> bool UnorderedSet<T>::Remove(const T &value) {
-  std::size_t index = Find(value);
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+bool UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Remove(const T &value) {
+  std::size_t index = Find(value, HashOf(value));
   if (index == kNotFound)
     return false;
-  for (std::size_t i = index; i + 1 < size_; ++i) {
-    data_[i] = data_[i + 1];
+  EraseAt(index);
+  return true;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::EraseAt(
+    std::size_t index) {
+  if (slots_ != nullptr)
+    EraseSlot(SlotOf(index));
+  std::size_t last = size_ - 1;
+  if (index != last) {
+    // Переносим последний элемент в освободившуюся позицию и исправляем
+    // ссылающуюся на него ячейку.
+    if (slots_ != nullptr)
+      slots_[SlotOf(last)] = index + 1;
+    data_[index] = std::move(data_[last]);
+    hashes_[index] = hashes_[last];
   }
+  data_[last].~T();
   --size_;
-  return true;
 }
 
-template <typename T>
-UnorderedSet<T> UnorderedSet<T>::Union(const UnorderedSet &other) const {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Union(
+    const UnorderedSet &other) const {
+  METRICS_ADD(kSetOperations, 1);
   UnorderedSet result(*this);
+  result.EnsureCapacity(size_ + other.size_);
   for (std::size_t i = 0; i < other.size_; ++i) {
-    result.Add(other.data_[i]);
+    if (result.Find(other.data_[i], other.hashes_[i]) == kNotFound) {
+      result.AppendNew(other.data_[i], other.hashes_[i]);
+    }
   }
   return result;
 }
 
-template <typename T>
-UnorderedSet<T> UnorderedSet<T>::Except(const UnorderedSet &other) const {
-  UnorderedSet result;
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Except(
+    const UnorderedSet &other) const {
+  METRICS_ADD(kSetOperations, 1);
+  UnorderedSet result(
+      hash_, equal_,
+      AllocTraits::select_on_container_copy_construction(allocator_));
   for (std::size_t i = 0; i < size_; ++i) {
-    if (!other.Contains(data_[i])) {
-      result.Add(data_[i]);
+    if (other.Find(data_[i], hashes_[i]) == kNotFound) {
+      result.AppendNew(data_[i], hashes_[i]);
     }
   }
   return result;
 }
 
-template <typename T>
-UnorderedSet<T> UnorderedSet<T>::Intersect(const UnorderedSet &other) const {
-  UnorderedSet result;
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Intersect(
+    const UnorderedSet &other) const {
+  METRICS_ADD(kSetOperations, 1);
+  UnorderedSet result(
+      hash_, equal_,
+      AllocTraits::select_on_container_copy_construction(allocator_));
   for (std::size_t i = 0; i < size_; ++i) {
-    if (other.Contains(data_[i])) {
-      result.Add(data_[i]);
+    if (other.Find(data_[i], hashes_[i]) != kNotFound) {
+      result.AppendNew(data_[i], hashes_[i]);
     }
   }
   return result;
 }
 
-template <typename T> std::vector<T> UnorderedSet<T>::ToVector() const {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnionWith(
+    const UnorderedSet &other) {
+  UnionWith(&other, &other + 1);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::IntersectWith(
+    const UnorderedSet &other) {
+  RetainWhere(&other, &other + 1, true);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::ExceptWith(
+    const UnorderedSet &other) {
+  RetainWhere(&other, &other + 1, false);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnionWith(
+    const UnorderedSet *first, const UnorderedSet *last) {
+  METRICS_ADD(kSetOperations, last - first);
+  std::size_t total = size_;
+  for (const UnorderedSet *set = first; set != last; ++set) {
+    if (set != this)
+      total += set->size_;
+  }
+  EnsureCapacity(total);
+  for (const UnorderedSet *set = first; set != last; ++set) {
+    if (set == this)
+      continue;
+    for (std::size_t i = 0; i < set->size_; ++i) {
+      if (Find(set->data_[i], set->hashes_[i]) == kNotFound) {
+        AppendNew(set->data_[i], set->hashes_[i]);
+      }
+    }
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::IntersectWith(
+    const UnorderedSet *first, const UnorderedSet *last) {
+  RetainWhere(first, last, true);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::ExceptWith(
+    const UnorderedSet *first, const UnorderedSet *last) {
+  RetainWhere(first, last, false);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::IntersectAll(
+    const UnorderedSet *first, const UnorderedSet *last, ThreadPool *pool) {
+  return ReduceAll(first, last, pool, true);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::UnionAll(
+    const UnorderedSet *first, const UnorderedSet *last, ThreadPool *pool) {
+  return ReduceAll(first, last, pool, false);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+typename UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::const_iterator
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::begin() const {
+  return data_;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+typename UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::const_iterator
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::end() const {
+  return data_ + size_;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+std::vector<T> UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::ToVector() const {
   return std::vector<T>(data_, data_ + size_);
 }
 
-template <typename T> void UnorderedSet<T>::Clear() {
-  delete[] data_;
-  data_ = nullptr;
-  size_ = 0;
-  capacity_ = 0;
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Clear() {
+  Release();
 }
 
-template <typename T> bool UnorderedSet<T>::IsEmpty() const {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+bool UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::IsEmpty() const {
   return size_ == 0;
 }
 
-template <typename T> void UnorderedSet<T>::Swap(UnorderedSet &other) noexcept {
-  std::swap(data_, other.data_);
-  std::swap(size_, other.size_);
-  std::swap(capacity_, other.capacity_);
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::ResetStorage() noexcept {
+  data_ = InlineData();
+  hashes_ = InlineHashes();
+  slots_ = nullptr;
+  size_ = 0;
+  capacity_ = InlineCapacity;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::TakeFrom(
+    UnorderedSet &other) noexcept(kNothrowMove) {
+  hash_ = other.hash_;
+  equal_ = other.equal_;
+  allocator_ = other.allocator_;
+  if (other.slots_ != nullptr) {
+    data_ = other.data_;
+    hashes_ = other.hashes_;
+    slots_ = other.slots_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+  } else {
+    // Встроенный буфер не переносится вместе с указателем.
+    for (; size_ < other.size_; ++size_) {
+      new (data_ + size_) T(std::move(other.data_[size_]));
+      other.data_[size_].~T();
+      hashes_[size_] = other.hashes_[size_];
+    }
+  }
+  other.ResetStorage();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+std::size_t UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::SlotOf(
+    std::size_t index) const {
+  std::size_t mask = 2 * capacity_ - 1;
+  std::size_t slot = hashes_[index] & mask;
+  while (slots_[slot] != index + 1)
+    slot = (slot + 1) & mask;
+  return slot;
 }
 
-template <typename T> std::size_t UnorderedSet<T>::Find(const T &value) const {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::InsertSlot(std::size_t index) {
+  if (slots_ == nullptr)
+    return;
+  std::size_t mask = 2 * capacity_ - 1;
+  std::size_t slot = hashes_[index] & mask;
+  while (slots_[slot] != kEmptySlot)
+    slot = (slot + 1) & mask;
+  slots_[slot] = index + 1;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::EraseSlot(std::size_t slot) {
+  std::size_t mask = 2 * capacity_ - 1;
+  std::size_t hole = slot;
+  for (std::size_t next = (hole + 1) & mask; slots_[next] != kEmptySlot;
+       next = (next + 1) & mask) {
+    std::size_t home = hashes_[slots_[next] - 1] & mask;
+    // Элемент можно сдвинуть в дыру, если его домашняя ячейка не лежит
+    // циклически в интервале (hole, next].
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      slots_[hole] = slots_[next];
+      hole = next;
+    }
+  }
+  slots_[hole] = kEmptySlot;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::AppendNew(
+    const T &value, std::size_t hash) {
+  EnsureCapacity(size_ + 1);
+  new (data_ + size_) T(value);
+  hashes_[size_] = hash;
+  InsertSlot(size_);
+  ++size_;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::AppendNew(
+    T &&value, std::size_t hash) {
+  EnsureCapacity(size_ + 1);
+  new (data_ + size_) T(std::move(value));
+  hashes_[size_] = hash;
+  InsertSlot(size_);
+  ++size_;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::RetainWhere(
+    const UnorderedSet *first, const UnorderedSet *last, bool keep_present) {
+  METRICS_ADD(kSetOperations, last - first);
+  // Само множество в диапазоне: пересечение с ним ничего не меняет
+  // (пропускается ниже), разность с ним пуста.
+  if (!keep_present) {
+    for (const UnorderedSet *set = first; set != last; ++set) {
+      if (set != this)
+        continue;
+      for (std::size_t i = 0; i < size_; ++i)
+        data_[i].~T();
+      if (slots_ != nullptr)
+        std::memset(slots_, 0, 2 * capacity_ * sizeof(std::size_t));
+      size_ = 0;
+      return;
+    }
+  }
+
+  // Уплотнение на месте: элемент i либо удаляется (ячейка освобождается
+  // обратным сдвигом), либо переезжает в позицию kept < i (ссылающаяся на
+  // него ячейка исправляется). Ячейки уже обработанных элементов ссылаются
+  // на позиции меньше i, поэтому SlotOf(i) находит именно элемент i.
+  std::size_t kept = 0;
   for (std::size_t i = 0; i < size_; ++i) {
-    if (data_[i] == value) {
-      return i;
+    bool keep = true;
+    for (const UnorderedSet *set = first; set != last; ++set) {
+      if (set == this)
+        continue;
+      bool present = set->Find(data_[i], hashes_[i]) != kNotFound;
+      if (present != keep_present) {
+        keep = false;
+        break;
+      }
+    }
+    if (!keep) {
+      if (slots_ != nullptr)
+        EraseSlot(SlotOf(i));
+      continue;
+    }
+    if (kept != i) {
+      if (slots_ != nullptr)
+        slots_[SlotOf(i)] = kept + 1;
+      data_[kept] = std::move(data_[i]);
+      hashes_[kept] = hashes_[i];
+    }
+    ++kept;
+  }
+  for (std::size_t i = kept; i < size_; ++i)
+    data_[i].~T();
+  size_ = kept;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::ReduceAll(
+    const UnorderedSet *first, const UnorderedSet *last, ThreadPool *pool,
+    bool intersect) {
+  if (first == last)
+    return UnorderedSet();
+  std::size_t count = static_cast<std::size_t>(last - first);
+  std::size_t blocks = pool == nullptr ? 1 : pool->ThreadCount() * 4;
+  if (blocks > count)
+    blocks = count;
+
+  // Для пересечения пустой частичный результат означает пустой ответ:
+  // флаг останавливает все блоки и уровни дерева.
+  std::atomic<bool> empty(false);
+  auto combine = [intersect, &empty](UnorderedSet &acc,
+                                     const UnorderedSet &next) {
+    if (intersect) {
+      acc.IntersectWith(next);
+      if (acc.IsEmpty())
+        empty.store(true, std::memory_order_relaxed);
+    } else {
+      acc.UnionWith(next);
+    }
+  };
+
+  // 1. Каждый блок сворачивается слева направо.
+  std::vector<UnorderedSet> partial(blocks);
+  auto fold_block = [&](std::size_t b) {
+    std::size_t begin = count * b / blocks;
+    std::size_t end = count * (b + 1) / blocks;
+    partial[b] = first[begin];
+    for (std::size_t i = begin + 1; i < end; ++i) {
+      if (intersect && empty.load(std::memory_order_relaxed))
+        return;
+      combine(partial[b], first[i]);
+    }
+    if (intersect && partial[b].IsEmpty())
+      empty.store(true, std::memory_order_relaxed);
+  };
+
+  // 2. Частичные результаты попарно сливаются деревом: на каждом уровне
+  //    partial[a] поглощает соседа справа, что сохраняет порядок элементов.
+  auto merge_level = [&](std::size_t stride) {
+    return [&, stride](std::size_t j) {
+      std::size_t a = 2 * j * stride;
+      std::size_t b = a + stride;
+      if (b < blocks && !(intersect && empty.load(std::memory_order_relaxed)))
+        combine(partial[a], partial[b]);
+    };
+  };
+
+  if (pool == nullptr) {
+    for (std::size_t b = 0; b < blocks; ++b)
+      fold_block(b);
+  } else {
+    pool->ParallelFor(blocks, fold_block);
+  }
+  for (std::size_t stride = 1; stride < blocks; stride *= 2) {
+    std::size_t pairs = (blocks + 2 * stride - 1) / (2 * stride);
+    if (pool == nullptr) {
+      auto body = merge_level(stride);
+      for (std::size_t j = 0; j < pairs; ++j)
+        body(j);
+    } else {
+      pool->ParallelFor(pairs, merge_level(stride));
     }
   }
-  return kNotFound;
+
+  if (intersect && empty.load(std::memory_order_relaxed))
+    return UnorderedSet(
+        first->hash_, first->equal_,
+        AllocTraits::select_on_container_copy_construction(first->allocator_));
+  return std::move(partial[0]);
 }
 
-template <typename T>
-void UnorderedSet<T>::EnsureCapacity(std::size_t min_capacity) {
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::EnsureCapacity(
+    std::size_t min_capacity) {
   if (capacity_ >= min_capacity)
     return;
+  METRICS_ADD(kContainerGrowths, 1);
   std::size_t new_capacity = capacity_ == 0 ? kInitialCapacity : capacity_ * 2;
   while (new_capacity < min_capacity)
     new_capacity *= 2;
-  T *new_data = new T[new_capacity];
+  Reallocate(new_capacity);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Reallocate(
+    std::size_t new_capacity) {
+  IndexAllocator index_allocator(allocator_);
+  T *new_data;
+  std::size_t *new_hashes;
+  std::size_t *new_slots = nullptr;
+  if (new_capacity <= InlineCapacity) {
+    new_capacity = InlineCapacity;
+    new_data = InlineData();
+    new_hashes = InlineHashes();
+  } else {
+    new_data = AllocTraits::allocate(allocator_, new_capacity);
+    try {
+      new_hashes = IndexTraits::allocate(index_allocator, 3 * new_capacity);
+    } catch (...) {
+      AllocTraits::deallocate(allocator_, new_data, new_capacity);
+      throw;
+    }
+    new_slots = new_hashes + new_capacity;
+    std::memset(new_slots, 0, 2 * new_capacity * sizeof(std::size_t));
+  }
+  // Перенос без промежуточных копий: элемент перемещается в
+  // неинициализированную память, старый сразу разрушается.
   for (std::size_t i = 0; i < size_; ++i) {
-    new_data[i] = data_[i];
+    new (new_data + i) T(std::move_if_noexcept(data_[i]));
+    data_[i].~T();
+    new_hashes[i] = hashes_[i];
+  }
+  if (slots_ != nullptr) {
+    AllocTraits::deallocate(allocator_, data_, capacity_);
+    IndexTraits::deallocate(index_allocator, hashes_, 3 * capacity_);
   }
-  delete[] data_;
   data_ = new_data;
+  hashes_ = new_hashes;
+  slots_ = new_slots;
   capacity_ = new_capacity;
+  for (std::size_t i = 0; i < size_; ++i) {
+    InsertSlot(i);
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Release() noexcept {
+  for (std::size_t i = 0; i < size_; ++i)
+    data_[i].~T();
+  if (slots_ != nullptr) {
+    AllocTraits::deallocate(allocator_, data_, capacity_);
+    IndexAllocator index_allocator(allocator_);
+    IndexTraits::deallocate(index_allocator, hashes_, 3 * capacity_);
+  }
+  ResetStorage();
 }
 
 template class UnorderedSet<int>;
-template class UnorderedSet<std::string>;
\ No newline at end of file
+template class UnorderedSet<std::uint32_t>;
+template class UnorderedSet<std::string>;
+template class UnorderedSet<std::uint32_t, std::hash<std::uint32_t>,
+                            std::equal_to<std::uint32_t>,
+                            ArenaAllocator<std::uint32_t>, 8>;
+template class UnorderedSet<int, std::hash<int>, std::equal_to<int>,
+                            ArenaAllocator<int>>;
+template class UnorderedSet<int, std::hash<int>, std::equal_to<int>,
+                            PoolAllocator<int>>;
+template class UnorderedSet<int, std::hash<int>, std::equal_to<int>,
+                            std::allocator<int>, 8>;
+template class UnorderedSet<std::string, std::hash<std::string>,
+                            std::equal_to<std::string>,
+                            PoolAllocator<std::string>>;
+template class UnorderedSet<std::string, StringHash, StringEqual>;
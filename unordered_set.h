@@ -1,21 +1,132 @@
 #ifndef UNORDERED_SET_H_
 #define UNORDERED_SET_H_
 
+#include "bit_ops.h"
+#include "metrics.h"
+#include "string_hash.h"
+
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+class ThreadPool;
+
+/// <summary>Встроенный буфер UnorderedSet: место под InlineCapacity элементов и
+/// их хешей внутри самого объекта.</summary>
+/// <remarks>Специализация для нулевой емкости пуста и за счет оптимизации
+/// пустого базового класса не увеличивает размер множества.</remarks>
+template <typename T, std::size_t InlineCapacity> class UnorderedSetInlineBuffer {
+protected:
+  T *InlineData() noexcept { return reinterpret_cast<T *>(inline_values_); }
+  std::size_t *InlineHashes() noexcept { return inline_hashes_; }
+
+private:
+  alignas(T) unsigned char inline_values_[InlineCapacity * sizeof(T)];
+  std::size_t inline_hashes_[InlineCapacity];
+};
+
+template <typename T> class UnorderedSetInlineBuffer<T, 0> {
+protected:
+  T *InlineData() noexcept { return nullptr; }
+  std::size_t *InlineHashes() noexcept { return nullptr; }
+};
+
 /// <summary>Класс, реализующий функционал неупорядоченного списка с уникальными
 /// элементами.</summary> <typeparam name="T">Тип элементов, хранящихся в
-/// множестве.</typeparam> <remarks>Доступ к элементам по индексу отсутствует.
-/// Дубликаты игнорируются при добавлении.</remarks>
-template <typename T> class UnorderedSet {
+/// множестве.</typeparam> <typeparam name="Hash">Хеш-функция для
+/// элементов.</typeparam> <typeparam name="KeyEqual">Предикат равенства
+/// элементов.</typeparam> <typeparam name="Allocator">Аллокатор элементов;
+/// служебные массивы выделяются им же через rebind.</typeparam>
+/// <typeparam name="InlineCapacity">Число элементов, которые хранятся прямо в
+/// объекте без выделения памяти (0 или степень двойки, не больше
+/// 64).</typeparam>
+/// <remarks>Доступ к элементам по индексу отсутствует.
+/// Дубликаты игнорируются при добавлении. Элементы хранятся плотным массивом в
+/// порядке добавления, поиск выполняется по хеш-таблице с открытой адресацией
+/// (линейное пробирование), поэтому Add/Contains/Remove работают за O(1) в
+/// среднем. Массив элементов — неинициализированная память: элементы
+/// конструируются только при добавлении и при росте перемещаются, а не
+/// копируются.
+///
+/// Итераторы (begin/end) — константные указатели в массив элементов, обход
+/// идет в порядке хранения. Любое добавление, Reserve, ShrinkToFit, Clear,
+/// присваивание и операции ...With делают недействительными все итераторы и
+/// ссылки. Remove делает недействительными итераторы на удаленный и на
+/// последний элемент (он переносится на место удаленного), а также
+/// end().
+///
+/// Пока элементов не больше InlineCapacity, они вместе с хешами лежат во
+/// встроенном буфере, хеш-таблицы нет, а поиск — линейный просмотр хешей без
+/// ветвлений с проверкой равенства только для совпавших. При росте сверх
+/// InlineCapacity элементы переезжают в память аллокатора и строится
+/// хеш-таблица; ShrinkToFit возвращает их во встроенный буфер, если они туда
+/// помещаются. Перемещение встроенного множества перемещает элементы по
+/// одному, поэтому итераторы исходного множества становятся
+/// недействительными.
+///
+/// Аллокатор переходит вместе с содержимым: перемещение и обмен переносят
+/// его, а копия получает select_on_container_copy_construction() (для
+/// ArenaAllocator это обычная куча). Результаты Union/Except/Intersect и
+/// IntersectAll/UnionAll — копии в этом смысле.
+///
+/// Если Hash и KeyEqual прозрачны (объявляют is_transparent, как StringHash
+/// и StringEqual), Contains, Add и Remove принимают ключ любого типа, с
+/// которым они работают: UnorderedSet&lt;std::string, StringHash,
+/// StringEqual&gt; ищет по std::string_view или const char* без временной
+/// строки.</remarks>
+template <typename T, typename Hash = std::hash<T>,
+          typename KeyEqual = std::equal_to<T>,
+          typename Allocator = std::allocator<T>,
+          std::size_t InlineCapacity = 0>
+class UnorderedSet
+    : private UnorderedSetInlineBuffer<T, InlineCapacity> {
+  static_assert(InlineCapacity <= 64 &&
+                    (InlineCapacity & (InlineCapacity - 1)) == 0,
+                "InlineCapacity must be 0 or a power of two up to 64");
+
 public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using const_iterator = const T *;
+  using iterator = const_iterator;
+  using allocator_type = Allocator;
+
+  /// <summary>Тип R, если Hash и KeyEqual прозрачны, а Key — не T (его
+  /// принимают обычные перегрузки); иначе перегрузка для ключа Key не
+  /// участвует в разрешении.</summary>
+  template <typename Key, typename R>
+  using IfTransparent =
+      std::enable_if_t<IsTransparentLookup<Hash, KeyEqual, Key>::value &&
+                           !std::is_same<Key, T>::value,
+                       R>;
+
+  /// <summary>Перемещение не бросает исключений: без встроенного буфера
+  /// переносятся только указатели.</summary>
+  static constexpr bool kNothrowMove =
+      InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value;
+
   /// <summary>Конструктор по умолчанию. Создает пустое множество.</summary>
   UnorderedSet();
 
+  /// <summary>Создает пустое множество с заданным аллокатором.</summary>
+  /// <param name="allocator">Аллокатор.</param>
+  explicit UnorderedSet(const Allocator &allocator);
+
+  /// <summary>Создает пустое множество с заданными хеш-функцией и предикатом
+  /// равенства.</summary>
+  /// <param name="hash">Хеш-функция.</param>
+  /// <param name="equal">Предикат равенства.</param>
+  /// <param name="allocator">Аллокатор.</param>
+  explicit UnorderedSet(const Hash &hash, const KeyEqual &equal = KeyEqual(),
+                        const Allocator &allocator = Allocator());
+
   /// <summary>Деструктор. Освобождает выделенную память.</summary>
   ~UnorderedSet();
 
@@ -30,32 +141,80 @@ public:
 
   /// <summary>Перемещающий конструктор.</summary>
   /// <param name="other">Множество для перемещения.</param>
-  UnorderedSet(UnorderedSet &&other) noexcept;
+  /// <remarks>Для встроенного множества элементы перемещаются по
+  /// одному.</remarks>
+  UnorderedSet(UnorderedSet &&other) noexcept(kNothrowMove);
 
   /// <summary>Оператор присваивания перемещением.</summary>
   /// <param name="other">Множество для перемещения.</param>
   /// <returns>Ссылка на текущий объект.</returns>
-  UnorderedSet &operator=(UnorderedSet &&other) noexcept;
+  UnorderedSet &operator=(UnorderedSet &&other) noexcept(kNothrowMove);
 
   /// <summary>Возвращает количество элементов в множестве.</summary>
   /// <returns>Количество элементов.</returns>
   std::size_t Size() const;
 
+  /// <summary>Возвращает копию аллокатора.</summary>
+  Allocator GetAllocator() const;
+
   /// <summary>Проверяет наличие элемента в множестве.</summary>
   /// <param name="value">Элемент для проверки.</param>
   /// <returns>true, если элемент найден, иначе false.</returns>
   bool Contains(const T &value) const;
 
+  /// <summary>Проверяет наличие элемента, равного key, не строя T (только
+  /// для прозрачных Hash и KeyEqual).</summary>
+  /// <param name="key">Ключ, например std::string_view.</param>
+  /// <returns>true, если элемент найден.</returns>
+  template <typename Key>
+  IfTransparent<Key, bool> Contains(const Key &key) const;
+
   /// <summary>Добавляет элемент в множество.</summary>
   /// <param name="value">Элемент для добавления.</param>
   /// <remarks>Если элемент уже существует, добавление не происходит.</remarks>
   void Add(const T &value);
 
+  /// <summary>Добавляет элемент в множество перемещением.</summary>
+  /// <param name="value">Элемент для добавления.</param>
+  /// <remarks>Если элемент уже существует, value не изменяется.</remarks>
+  void Add(T &&value);
+
+  /// <summary>Добавляет элемент T(key), если равного key еще нет (только для
+  /// прозрачных Hash и KeyEqual).</summary>
+  /// <param name="key">Ключ, например std::string_view.</param>
+  /// <remarks>Элемент строится только при добавлении; если он уже есть,
+  /// память не выделяется.</remarks>
+  template <typename Key> IfTransparent<Key, void> Add(const Key &key);
+
+  /// <summary>Конструирует элемент из аргументов и добавляет его.</summary>
+  /// <param name="args">Аргументы конструктора T.</param>
+  /// <returns>true, если элемент добавлен; false, если такой уже
+  /// был.</returns>
+  template <typename... Args> bool Emplace(Args &&...args);
+
+  /// <summary>Заранее выделяет место под count элементов.</summary>
+  /// <param name="count">Ожидаемое количество элементов.</param>
+  void Reserve(std::size_t count);
+
+  /// <summary>Уменьшает емкость до наименьшей степени двойки, вмещающей
+  /// текущие элементы; у пустого множества освобождает всю память.</summary>
+  /// <remarks>Если элементы помещаются во встроенный буфер, они переносятся
+  /// туда, а память освобождается.</remarks>
+  void ShrinkToFit();
+
   /// <summary>Удаляет элемент из множества.</summary>
   /// <param name="value">Элемент для удаления.</param>
   /// <returns>true, если элемент был удален, иначе false.</returns>
+  /// <remarks>На место удаленного элемента переносится последний, поэтому
+  /// порядок оставшихся элементов может измениться.</remarks>
   bool Remove(const T &value);
 
+  /// <summary>Удаляет элемент, равный key (только для прозрачных Hash и
+  /// KeyEqual).</summary>
+  /// <param name="key">Ключ, например std::string_view.</param>
+  /// <returns>true, если элемент был удален.</returns>
+  template <typename Key> IfTransparent<Key, bool> Remove(const Key &key);
+
   /// <summary>Объединяет текущее множество с другим.</summary>
   /// <param name="other">Множество для объединения.</param>
   /// <returns>Новое множество, содержащее все элементы из обоих
@@ -73,6 +232,85 @@ public:
   /// <returns>Новое множество, содержащее только общие элементы.</returns>
   UnorderedSet Intersect(const UnorderedSet &other) const;
 
+  /// <summary>Добавляет в текущее множество элементы другого.</summary>
+  /// <param name="other">Множество для объединения.</param>
+  /// <remarks>Результат и порядок элементов — как у Union, но без создания
+  /// нового множества.</remarks>
+  void UnionWith(const UnorderedSet &other);
+
+  /// <summary>Оставляет в текущем множестве только элементы, присутствующие в
+  /// другом.</summary>
+  /// <param name="other">Множество для пересечения.</param>
+  /// <remarks>Как Intersect, но на месте: оставшиеся элементы сдвигаются к
+  /// началу массива с сохранением порядка, память не выделяется.</remarks>
+  void IntersectWith(const UnorderedSet &other);
+
+  /// <summary>Удаляет из текущего множества элементы, присутствующие в
+  /// другом.</summary>
+  /// <param name="other">Множество, элементы которого нужно удалить.</param>
+  /// <remarks>Как Except, но на месте, без выделения памяти.</remarks>
+  void ExceptWith(const UnorderedSet &other);
+
+  /// <summary>Добавляет в текущее множество элементы всех множеств
+  /// диапазона.</summary>
+  /// <param name="first">Начало диапазона множеств.</param>
+  /// <param name="last">Конец диапазона множеств (не включается).</param>
+  /// <remarks>Место под все элементы резервируется один раз.</remarks>
+  void UnionWith(const UnorderedSet *first, const UnorderedSet *last);
+
+  /// <summary>Оставляет только элементы, присутствующие во всех множествах
+  /// диапазона.</summary>
+  /// <param name="first">Начало диапазона множеств.</param>
+  /// <param name="last">Конец диапазона множеств (не включается).</param>
+  /// <remarks>Один проход по текущему множеству: каждый элемент проверяется
+  /// по множествам диапазона до первого промаха.</remarks>
+  void IntersectWith(const UnorderedSet *first, const UnorderedSet *last);
+
+  /// <summary>Удаляет элементы, присутствующие хотя бы в одном множестве
+  /// диапазона.</summary>
+  /// <param name="first">Начало диапазона множеств.</param>
+  /// <param name="last">Конец диапазона множеств (не включается).</param>
+  void ExceptWith(const UnorderedSet *first, const UnorderedSet *last);
+
+  /// <summary>Находит пересечение всех множеств диапазона.</summary>
+  /// <param name="first">Начало диапазона множеств.</param>
+  /// <param name="last">Конец диапазона множеств (не включается).</param>
+  /// <param name="pool">Пул потоков или nullptr для последовательного
+  /// выполнения.</param>
+  /// <returns>Пересечение; для пустого диапазона — пустое множество.</returns>
+  /// <remarks>Диапазон делится на блоки, которые сворачиваются параллельно,
+  /// затем частичные результаты попарно пересекаются деревом. Как только
+  /// какой-либо частичный результат становится пустым, работа прекращается.
+  /// Порядок элементов тот же, что у последовательной свертки
+  /// first[0].Intersect(first[1]).Intersect(...).</remarks>
+  static UnorderedSet IntersectAll(const UnorderedSet *first,
+                                   const UnorderedSet *last,
+                                   ThreadPool *pool = nullptr);
+
+  /// <summary>Находит объединение всех множеств диапазона.</summary>
+  /// <param name="first">Начало диапазона множеств.</param>
+  /// <param name="last">Конец диапазона множеств (не включается).</param>
+  /// <param name="pool">Пул потоков или nullptr для последовательного
+  /// выполнения.</param>
+  /// <returns>Объединение; для пустого диапазона — пустое множество.</returns>
+  /// <remarks>Параллельная древовидная свертка, как у IntersectAll. Порядок
+  /// элементов тот же, что у последовательной свертки Union.</remarks>
+  static UnorderedSet UnionAll(const UnorderedSet *first,
+                               const UnorderedSet *last,
+                               ThreadPool *pool = nullptr);
+
+  /// <summary>Итератор на первый элемент.</summary>
+  const_iterator begin() const;
+
+  /// <summary>Итератор за последним элементом.</summary>
+  const_iterator end() const;
+
+  /// <summary>Вызывает visitor(элемент) для каждого элемента в порядке
+  /// хранения.</summary>
+  /// <param name="visitor">Функция, принимающая const T&amp;; не должна
+  /// изменять множество.</param>
+  template <typename Visitor> void ForEach(Visitor visitor) const;
+
   /// <summary>Преобразует множество в вектор для удобства вывода.</summary>
   /// <returns>Вектор, содержащий все элементы множества.</returns>
   std::vector<T> ToVector() const;
@@ -87,23 +325,245 @@ public:
 private:
   static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
   static constexpr std::size_t kInitialCapacity = 4;
+  /// <summary>Пустая ячейка хеш-таблицы.</summary>
+  static constexpr std::size_t kEmptySlot = 0;
+
+  using AllocTraits = std::allocator_traits<Allocator>;
+  using IndexAllocator =
+      typename AllocTraits::template rebind_alloc<std::size_t>;
+  using IndexTraits = std::allocator_traits<IndexAllocator>;
+
+  using UnorderedSetInlineBuffer<T, InlineCapacity>::InlineData;
+  using UnorderedSetInlineBuffer<T, InlineCapacity>::InlineHashes;
 
+  /// <summary>Элементы: встроенный буфер или массив аллокатора.</summary>
   T *data_;
+  /// <summary>Хеши элементов, параллельно data_. Во встроенном режиме — буфер
+  /// хешей объекта; иначе начало общего блока из
+  /// 3 * capacity_ чисел, в котором за хешами лежат ячейки slots_: одно
+  /// выделение вместо двух.</summary>
+  std::size_t *hashes_;
+  /// <summary>Ячейки хеш-таблицы: индекс элемента в data_ плюс один, либо
+  /// kEmptySlot. Размер — 2 * capacity_ (степень двойки), поэтому
+  /// заполненность не превышает 1/2. nullptr, пока элементы во встроенном
+  /// буфере или память не выделена.</summary>
+  std::size_t *slots_;
   std::size_t size_;
   std::size_t capacity_;
+  Hash hash_;
+  KeyEqual equal_;
+  Allocator allocator_;
 
-  /// <summary>Обменивает содержимое текущего объекта с другим.</summary>
-  /// <param name="other">Объект для обмена.</param>
-  void Swap(UnorderedSet &other) noexcept;
+  /// <summary>Переводит множество в пустое состояние без выделенной памяти
+  /// (во встроенный буфер, если он есть).</summary>
+  /// <remarks>Элементы должны быть уже разрушены, память
+  /// освобождена.</remarks>
+  void ResetStorage() noexcept;
+
+  /// <summary>Забирает содержимое и аллокатор другого множества, оставляя
+  /// его пустым.</summary>
+  /// <param name="other">Исходное множество.</param>
+  /// <remarks>Текущее множество должно быть в состоянии
+  /// ResetStorage.</remarks>
+  void TakeFrom(UnorderedSet &other) noexcept(kNothrowMove);
+
+  /// <summary>Вычисляет хеш элемента с дополнительным перемешиванием
+  /// битов.</summary>
+  /// <param name="value">Элемент или прозрачный ключ.</param>
+  /// <returns>Хеш элемента.</returns>
+  template <typename Key> std::size_t HashOf(const Key &value) const;
 
   /// <summary>Находит индекс элемента в массиве.</summary>
-  /// <param name="value">Элемент для поиска.</param>
+  /// <param name="value">Элемент или прозрачный ключ для поиска.</param>
+  /// <param name="hash">Хеш элемента (результат HashOf).</param>
   /// <returns>Индекс элемента или kNotFound, если элемент не найден.</returns>
-  std::size_t Find(const T &value) const;
+  template <typename Key>
+  std::size_t Find(const Key &value, std::size_t hash) const;
+
+  /// <summary>Линейный поиск во встроенном буфере.</summary>
+  /// <param name="value">Элемент или прозрачный ключ для поиска.</param>
+  /// <param name="hash">Хеш элемента.</param>
+  /// <returns>Индекс элемента или kNotFound.</returns>
+  template <typename Key>
+  std::size_t FindInline(const Key &value, std::size_t hash) const;
+
+  /// <summary>Удаляет элемент с заданным индексом, перенося на его место
+  /// последний.</summary>
+  /// <param name="index">Индекс элемента в data_.</param>
+  void EraseAt(std::size_t index);
+
+  /// <summary>Находит ячейку хеш-таблицы, ссылающуюся на элемент с заданным
+  /// индексом.</summary>
+  /// <param name="index">Индекс элемента в data_.</param>
+  /// <returns>Номер ячейки.</returns>
+  std::size_t SlotOf(std::size_t index) const;
+
+  /// <summary>Заносит элемент с заданным индексом в хеш-таблицу (во
+  /// встроенном режиме ничего не делает).</summary>
+  /// <param name="index">Индекс элемента в data_.</param>
+  void InsertSlot(std::size_t index);
+
+  /// <summary>Освобождает ячейку, сдвигая назад следующие за ней элементы
+  /// кластера (удаление без надгробий).</summary>
+  /// <param name="slot">Номер освобождаемой ячейки.</param>
+  void EraseSlot(std::size_t slot);
+
+  /// <summary>Добавляет элемент, заведомо отсутствующий в множестве.</summary>
+  /// <param name="value">Элемент.</param>
+  /// <param name="hash">Хеш элемента.</param>
+  void AppendNew(const T &value, std::size_t hash);
+
+  /// <summary>Добавляет перемещением элемент, заведомо отсутствующий в
+  /// множестве.</summary>
+  /// <param name="value">Элемент.</param>
+  /// <param name="hash">Хеш элемента.</param>
+  void AppendNew(T &&value, std::size_t hash);
+
+  /// <summary>Оставляет элементы, для которых наличие в множествах диапазона
+  /// совпадает с требуемым, сохраняя их порядок.</summary>
+  /// <param name="first">Начало диапазона множеств.</param>
+  /// <param name="last">Конец диапазона множеств (не включается).</param>
+  /// <param name="keep_present">true — оставить элементы, которые есть во
+  /// всех множествах; false — элементы, которых нет ни в одном.</param>
+  void RetainWhere(const UnorderedSet *first, const UnorderedSet *last,
+                   bool keep_present);
+
+  /// <summary>Сворачивает диапазон множеств параллельным деревом.</summary>
+  /// <param name="first">Начало диапазона.</param>
+  /// <param name="last">Конец диапазона.</param>
+  /// <param name="pool">Пул потоков или nullptr.</param>
+  /// <param name="intersect">true — пересечение (с ранней остановкой на
+  /// пустом результате), false — объединение.</param>
+  /// <returns>Результат свертки.</returns>
+  static UnorderedSet ReduceAll(const UnorderedSet *first,
+                                const UnorderedSet *last, ThreadPool *pool,
+                                bool intersect);
 
   /// <summary>Обеспечивает минимальную емкость массива.</summary>
   /// <param name="min_capacity">Минимальная требуемая емкость.</param>
   void EnsureCapacity(std::size_t min_capacity);
+
+  /// <summary>Переносит элементы в новые массивы заданной емкости и
+  /// перестраивает хеш-таблицу.</summary>
+  /// <param name="new_capacity">Новая емкость (степень двойки, не меньше
+  /// size_); не больше InlineCapacity — перенос во встроенный буфер.</param>
+  void Reallocate(std::size_t new_capacity);
+
+  /// <summary>Разрушает элементы и освобождает все массивы.</summary>
+  void Release() noexcept;
 };
 
-#endif // UNORDERED_SET_H_
\ No newline at end of file
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename Visitor>
+void UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::ForEach(
+    Visitor visitor) const {
+  for (std::size_t i = 0; i < size_; ++i)
+    visitor(data_[i]);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename Key>
+typename UnorderedSet<T, Hash, KeyEqual, Allocator,
+                      InlineCapacity>::template IfTransparent<Key, bool>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Contains(
+    const Key &key) const {
+  return Find(key, HashOf(key)) != kNotFound;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename Key>
+typename UnorderedSet<T, Hash, KeyEqual, Allocator,
+                      InlineCapacity>::template IfTransparent<Key, void>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Add(
+    const Key &key) {
+  std::size_t hash = HashOf(key);
+  if (Find(key, hash) != kNotFound)
+    return;
+  AppendNew(T(key), hash);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename Key>
+typename UnorderedSet<T, Hash, KeyEqual, Allocator,
+                      InlineCapacity>::template IfTransparent<Key, bool>
+UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Remove(
+    const Key &key) {
+  std::size_t index = Find(key, HashOf(key));
+  if (index == kNotFound)
+    return false;
+  EraseAt(index);
+  return true;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename Key>
+std::size_t UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::HashOf(
+    const Key &value) const {
+  // std::hash для целых чисел — тождественная функция, поэтому перемешиваем
+  // биты (фибоначчиево хеширование), чтобы младшие биты были равномерны.
+  unsigned long long h = static_cast<unsigned long long>(hash_(value));
+  h ^= h >> 32;
+  h *= 0x9E3779B97F4A7C15ULL;
+  return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename Key>
+std::size_t UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Find(
+    const Key &value, std::size_t hash) const {
+  if (slots_ == nullptr)
+    return FindInline(value, hash);
+  std::size_t mask = 2 * capacity_ - 1;
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    std::size_t entry = slots_[slot];
+    if (entry == kEmptySlot) {
+      METRICS_PROBE(((slot - hash) & mask) + 1);
+      return kNotFound;
+    }
+    std::size_t index = entry - 1;
+    if (hashes_[index] == hash && equal_(data_[index], value)) {
+      METRICS_PROBE(((slot - hash) & mask) + 1);
+      return index;
+    }
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename Key>
+std::size_t UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::FindInline(
+    const Key &value, std::size_t hash) const {
+  // Сначала все хеши сравниваются без переходов (маска совпадений), затем
+  // равенство проверяется только для совпавших — обычно не больше одного.
+  std::uint64_t matches = 0;
+  for (std::size_t i = 0; i < size_; ++i)
+    matches |= static_cast<std::uint64_t>(hashes_[i] == hash) << i;
+  for (; matches != 0; matches &= matches - 1) {
+    std::size_t index = CountTrailingZeros(matches);
+    if (equal_(data_[index], value))
+      return index;
+  }
+  return kNotFound;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Allocator,
+          std::size_t InlineCapacity>
+template <typename... Args>
+bool UnorderedSet<T, Hash, KeyEqual, Allocator, InlineCapacity>::Emplace(Args &&...args) {
+  // Элемент собирается до поиска: аргументы могут ссылаться на элементы
+  // множества, которые сдвинутся при росте массива.
+  T value(std::forward<Args>(args)...);
+  std::size_t hash = HashOf(value);
+  if (Find(value, hash) != kNotFound)
+    return false;
+  AppendNew(std::move(value), hash);
+  return true;
+}
+
+#endif // UNORDERED_SET_H_
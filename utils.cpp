@@ -1,32 +1,265 @@
 #include "utils.h"
-#include <cctype>
-#include <sstream>
+
+#include "bit_ops.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// Длина пробельного символа UTF-8 в начале [p, p + size) или 0, если там не пробел.
+std::size_t SpaceLength(const unsigned char* p, std::size_t size) {
+    if (p[0] < 0x80) {
+        return p[0] == ' ' || (p[0] >= '\t' && p[0] <= '\r') ? 1 : 0;
+    }
+    if (p[0] == 0xC2) {
+        // U+0085, U+00A0
+        return size >= 2 && (p[1] == 0x85 || p[1] == 0xA0) ? 2 : 0;
+    }
+    if (size < 3) {
+        return 0;
+    }
+    if (p[0] == 0xE1) {
+        // U+1680
+        return p[1] == 0x9A && p[2] == 0x80 ? 3 : 0;
+    }
+    if (p[0] == 0xE2) {
+        // U+2000–U+200A, U+2028, U+2029, U+202F, U+205F
+        if (p[1] == 0x80) {
+            bool space = (p[2] >= 0x80 && p[2] <= 0x8A) || p[2] == 0xA8 || p[2] == 0xA9 ||
+                         p[2] == 0xAF;
+            return space ? 3 : 0;
+        }
+        return p[1] == 0x81 && p[2] == 0x9F ? 3 : 0;
+    }
+    if (p[0] == 0xE3) {
+        // U+3000
+        return p[1] == 0x80 && p[2] == 0x80 ? 3 : 0;
+    }
+    return 0;
+}
+
+/// Длина пробельного символа UTF-8, которым заканчивается [p, p + size), или 0.
+std::size_t TrailingSpaceLength(const unsigned char* p, std::size_t size) {
+    if (p[size - 1] < 0x80) {
+        return SpaceLength(p + size - 1, 1);
+    }
+    if (size >= 2 && SpaceLength(p + size - 2, 2) == 2) {
+        return 2;
+    }
+    if (size >= 3 && SpaceLength(p + size - 3, 3) == 3) {
+        return 3;
+    }
+    return 0;
+}
+
+/// Длина символа UTF-8 в начале [p, p + size); некорректная или оборванная
+/// последовательность считается одним байтом.
+std::size_t SequenceLength(const unsigned char* p, std::size_t size) {
+    std::size_t length = 1;
+    if (p[0] >= 0xC2 && p[0] <= 0xDF) {
+        length = 2;
+    } else if (p[0] >= 0xE0 && p[0] <= 0xEF) {
+        length = 3;
+    } else if (p[0] >= 0xF0 && p[0] <= 0xF4) {
+        length = 4;
+    }
+    if (length > size) {
+        return 1;
+    }
+    for (std::size_t k = 1; k < length; ++k) {
+        if ((p[k] & 0xC0) != 0x80) {
+            return 1;
+        }
+    }
+    return length;
+}
+
+/// Число первых байтов, которые NormalizeTitle переносит без разбора: ASCII без управляющих
+/// символов, пробела и заглавных букв.
+std::size_t PlainPrefix(const char* data, std::size_t size) {
+    std::size_t i = 0;
+    // Байты сравниваются как знаковые: всё, что не меньше 0x80, попадает в «< 0x21».
+#if defined(__AVX2__)
+    const __m256i space = _mm256_set1_epi8(0x21);
+    const __m256i before_upper = _mm256_set1_epi8(0x40);
+    const __m256i after_upper = _mm256_set1_epi8(0x5B);
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i special = _mm256_or_si256(
+            _mm256_cmpgt_epi8(space, v),
+            _mm256_and_si256(_mm256_cmpgt_epi8(v, before_upper),
+                             _mm256_cmpgt_epi8(after_upper, v)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask);
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x21);
+    const __m128i before_upper = _mm_set1_epi8(0x40);
+    const __m128i after_upper = _mm_set1_epi8(0x5B);
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i special = _mm_or_si128(
+            _mm_cmplt_epi8(v, space),
+            _mm_and_si128(_mm_cmpgt_epi8(v, before_upper), _mm_cmplt_epi8(v, after_upper)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c <= ' ' || c >= 0x80 || (c >= 'A' && c <= 'Z')) {
+            break;
+        }
+    }
+    return i;
+}
+
+} // namespace
 
 std::string Trim(const std::string& str) {
+    return std::string(Trim(std::string_view(str)));
+}
+
+std::vector<std::string> Split(const std::string& str, char delimiter) {
+    std::vector<std::string_view> tokens;
+    Split(std::string_view(str), delimiter, tokens);
+    return std::vector<std::string>(tokens.begin(), tokens.end());
+}
+
+std::string_view Trim(std::string_view str) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(str.data());
     std::size_t start = 0;
-    while (start < str.size() && std::isspace(static_cast<unsigned char>(str[start]))) {
-        ++start;
+    while (start < str.size()) {
+        std::size_t length = SpaceLength(p + start, str.size() - start);
+        if (length == 0) {
+            break;
+        }
+        start += length;
     }
 
     std::size_t end = str.size();
-    while (end > start && std::isspace(static_cast<unsigned char>(str[end - 1]))) {
-        --end;
+    while (end > start) {
+        std::size_t length = TrailingSpaceLength(p + start, end - start);
+        if (length == 0) {
+            break;
+        }
+        end -= length;
     }
 
     return str.substr(start, end - start);
 }
 
-std::vector<std::string> Split(const std::string& str, char delimiter) {
-    std::vector<std::string> result;
-    std::istringstream iss(str);
-    std::string token;
+std::string_view NormalizeTitle(std::string_view title, std::string& buffer) {
+    const char* data = title.data();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    std::size_t size = title.size();
+    // title[flushed, i) совпадает с результатом и еще не скопирован в buffer: пока замен не
+    // было, buffer не трогается и возвращается сам title.
+    std::size_t flushed = 0;
+    bool changed = false;
+    auto replace = [&](std::size_t from, std::size_t to, const char* with, std::size_t length) {
+        if (!changed) {
+            buffer.clear();
+            changed = true;
+        }
+        buffer.append(data + flushed, from - flushed);
+        buffer.append(with, length);
+        flushed = to;
+    };
 
-    while (std::getline(iss, token, delimiter)) {
-        std::string trimmed = Trim(token);
+    std::size_t i = 0;
+    while (true) {
+        i += PlainPrefix(data + i, size - i);
+        if (i == size) {
+            break;
+        }
+        unsigned char c = p[i];
+        std::size_t space = SpaceLength(p + i, size - i);
+        if (space != 0) {
+            std::size_t end = i + space;
+            while (end < size && (space = SpaceLength(p + end, size - end)) != 0) {
+                end += space;
+            }
+            if (i == 0 || end == size) {
+                replace(i, end, "", 0);
+            } else if (end - i != 1 || c != ' ') {
+                replace(i, end, " ", 1);
+            }
+            i = end;
+        } else if (c >= 'A' && c <= 'Z') {
+            char lower = static_cast<char>(c + ('a' - 'A'));
+            replace(i, i + 1, &lower, 1);
+            ++i;
+        } else if (c == 0xD0 && i + 1 < size && p[i + 1] >= 0x80 && p[i + 1] <= 0xAF) {
+            // Заглавные кириллические U+0400–U+042F; Ё (U+0401) сразу становится «е».
+            unsigned char next = p[i + 1];
+            char lower[2];
+            if (next == 0x81) {
+                lower[0] = static_cast<char>(0xD0);
+                lower[1] = static_cast<char>(0xB5);
+            } else if (next < 0x90) {
+                // U+0400–U+040F -> U+0450–U+045F
+                lower[0] = static_cast<char>(0xD1);
+                lower[1] = static_cast<char>(next + 0x10);
+            } else if (next < 0xA0) {
+                // А–П -> а–п
+                lower[0] = static_cast<char>(0xD0);
+                lower[1] = static_cast<char>(next + 0x20);
+            } else {
+                // Р–Я -> р–я
+                lower[0] = static_cast<char>(0xD1);
+                lower[1] = static_cast<char>(next - 0x20);
+            }
+            replace(i, i + 2, lower, 2);
+            i += 2;
+        } else if (c == 0xD1 && i + 1 < size && p[i + 1] == 0x91) {
+            // ё -> е
+            replace(i, i + 2, "\xD0\xB5", 2);
+            i += 2;
+        } else {
+            i += SequenceLength(p + i, size - i);
+        }
+    }
+
+    if (!changed) {
+        return title;
+    }
+    buffer.append(data + flushed, size - flushed);
+    return buffer;
+}
+
+void Split(std::string_view str, char delimiter, std::vector<std::string_view>& tokens) {
+    tokens.clear();
+    while (!str.empty()) {
+        std::size_t pos = str.find(delimiter);
+        std::string_view trimmed = Trim(str.substr(0, pos));
         if (!trimmed.empty()) {
-            result.push_back(trimmed);
+            tokens.push_back(trimmed);
+        }
+        if (pos == std::string_view::npos) {
+            break;
         }
+        str.remove_prefix(pos + 1);
     }
+}
 
-    return result;
-}
\ No newline at end of file
+bool NextLine(std::string_view& rest, std::string_view& line) {
+    if (rest.empty()) {
+        return false;
+    }
+    std::size_t pos = rest.find('\n');
+    if (pos == std::string_view::npos) {
+        line = rest;
+        rest = std::string_view();
+    } else {
+        line = rest.substr(0, pos);
+        rest.remove_prefix(pos + 1);
+    }
+    return true;
+}
@@ -2,6 +2,7 @@
 #define UTILS_H_
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 /// <summary>Удаляет пробельные символы с начала и конца строки.</summary>
@@ -15,4 +16,35 @@ std::string Trim(const std::string& str);
 /// <returns>Вектор строк, полученных разделением входной строки.</returns>
 std::vector<std::string> Split(const std::string& str, char delimiter);
 
-#endif // UTILS_H_
\ No newline at end of file
+/// <summary>Удаляет пробельные символы с начала и конца строки без копирования.</summary>
+/// <param name="str">Входная строка в UTF-8.</param>
+/// <returns>Представление обрезанной части исходной строки.</returns>
+/// <remarks>Кроме пробельных символов ASCII удаляются пробелы Unicode (свойство White_Space):
+/// неразрывный U+00A0, тонкие и прочие U+2000–U+200A, U+202F, U+3000 и т. п.</remarks>
+std::string_view Trim(std::string_view str);
+
+/// <summary>Разделяет строку по разделителю без копирования символов.</summary>
+/// <param name="str">Входная строка для разделения.</param>
+/// <param name="delimiter">Разделитель для использования.</param>
+/// <param name="tokens">Выходной вектор: очищается и заполняется обрезанными непустыми
+/// подстроками. Повторное использование одного вектора избавляет от выделений памяти.</param>
+void Split(std::string_view str, char delimiter, std::vector<std::string_view>& tokens);
+
+/// <summary>Приводит название к единому виду, чтобы варианты написания совпадали.</summary>
+/// <param name="title">Название в UTF-8.</param>
+/// <param name="buffer">Буфер для результата; используется, только если название меняется.</param>
+/// <returns>title, если название уже нормализовано (без копирования), иначе
+/// представление buffer.</returns>
+/// <remarks>Пробелы (ASCII и Unicode) по краям удаляются, подряд идущие внутри заменяются одним
+/// ' '; латиница и кириллица приводятся к нижнему регистру, «ё» заменяется на «е». Остальные
+/// символы и некорректные байты UTF-8 копируются как есть. Байты, не требующие разбора
+/// (ASCII без заглавных букв и пробелов), пропускаются блоками по 16–32 (SSE2/AVX2).</remarks>
+std::string_view NormalizeTitle(std::string_view title, std::string& buffer);
+
+/// <summary>Отделяет очередную строку (до '\n') от начала буфера.</summary>
+/// <param name="rest">Непрочитанная часть буфера; сдвигается за выделенную строку.</param>
+/// <param name="line">Выделенная строка без символа перевода строки.</param>
+/// <returns>false, если буфер исчерпан.</returns>
+bool NextLine(std::string_view& rest, std::string_view& line);
+
+#endif // UTILS_H_